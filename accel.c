@@ -0,0 +1,165 @@
+#include <inttypes.h>
+
+#include "accel.h"
+#include "adxl345.h"
+#include "defs.h"
+#include "globals.h"
+#include "i2cmaster.h"
+#include "vib.h"
+
+/*-----------------------------------------------------------------------*/
+
+// the current accelerations
+static int16_t s_accel[3];
+static uint16_t s_overruns;
+
+#ifdef SENSOR_FIFO
+
+// adxl345 registers
+#define ADXL_BW_RATE        0x2C
+#define ADXL_DATAX0         0x32
+#define ADXL_FIFO_CTL       0x38
+#define ADXL_FIFO_STATUS    0x39
+
+#define ADXL_FIFO_BYPASS    0x00    // FIFO_CTL mode
+#define ADXL_FIFO_STREAM    0x80
+#define ADXL_FIFO_ENTRIES   0x3F    // FIFO_STATUS
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t accel_write(uint8_t reg, uint8_t val)
+{
+	if (i2c_start(ADXL345_ADDRESS + I2C_WRITE)) {
+		i2c_stop();
+		return 1;
+	}
+	i2c_write(reg);
+	i2c_write(val);
+	i2c_stop();
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t accel_read(uint8_t reg, uint8_t* buf, uint8_t len)
+{
+	if (i2c_start(ADXL345_ADDRESS + I2C_WRITE)) {
+		i2c_stop();
+		return 1;
+	}
+	i2c_write(reg);
+	i2c_rep_start(ADXL345_ADDRESS + I2C_READ);
+	while (--len)
+		*buf++ = i2c_readAck();
+	*buf = i2c_readNak();
+	i2c_stop();
+	return 0;
+}
+
+#endif  // SENSOR_FIFO
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t accel_init(void)
+{
+	s_overruns = 0;
+#ifdef SENSOR_FIFO
+	// bypass empties the FIFO
+	if (accel_write(ADXL_BW_RATE, ACCEL_BW_RATE)
+		|| accel_write(ADXL_FIFO_CTL, ADXL_FIFO_BYPASS)
+		|| accel_write(ADXL_FIFO_CTL, ADXL_FIFO_STREAM))
+		return 1;
+#endif
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+#ifdef SENSOR_FIFO
+
+// the 80hz frame is longer than two sample periods, so there is always
+// a new sample when an update starts, even with some jitter
+STATIC_ASSERT(accel_sample_hz, ACCEL_SAMPLE_HZ >= 2 * 80);
+
+// one sample off the FIFO, 'n' the entries left, 1 if the bus failed
+static uint8_t accel_read_entry(int16_t* raw, uint8_t* n)
+{
+	// little endian x, y, z, then FIFO_CTL and FIFO_STATUS
+	uint8_t buf[ADXL_FIFO_STATUS - ADXL_DATAX0 + 1];
+	if (accel_read(ADXL_DATAX0, buf, sizeof(buf)))
+		return 1;
+	for (uint8_t i=0; i<3; ++i)
+		raw[i] = (int16_t)(((uint16_t)buf[i * 2 + 1] << 8) | buf[i * 2]);
+	*n = buf[ADXL_FIFO_STATUS - ADXL_DATAX0] & ADXL_FIFO_ENTRIES;
+	return 0;
+}
+
+uint8_t accel_update(void)
+{
+	int32_t sum[3] = {0, 0, 0};
+	uint8_t count = 0;
+	uint8_t n;
+
+	// every read takes a sample off the FIFO and says how many are left,
+	// one i2c transaction per sample
+	do {
+		int16_t raw[3];
+		if (accel_read_entry(raw, &n)) {
+			vib_restart();
+			return 0;
+		}
+		if (count + 1 + n > ACCEL_FIFO_MAX) {
+			// in bypass the data registers hold the newest sample
+			++s_overruns;
+			vib_restart();
+			if (accel_write(ADXL_FIFO_CTL, ADXL_FIFO_BYPASS)
+				|| accel_read_entry(raw, &n)
+				|| accel_write(ADXL_FIFO_CTL, ADXL_FIFO_STREAM))
+				return 0;
+			for (uint8_t i=0; i<3; ++i)
+				sum[i] = 0;
+			count = 0;
+			n = 0;
+		}
+		// the vibration monitor sees all of them
+		uint8_t v = g_adxl345_dev.axis_map[VIB_AXIS];
+		vib_sample(raw[v] * g_adxl345_dev.sign_map[VIB_AXIS]);
+		for (uint8_t i=0; i<3; ++i)
+			sum[i] += raw[i];
+		++count;
+	} while (n);
+
+	// the average of all of them, count is at most ACCEL_FIFO_MAX
+	for (uint8_t i=0; i<3; ++i) {
+		int16_t v = (int16_t)(sum[g_adxl345_dev.axis_map[i]] / count);
+		s_accel[i] = v * g_adxl345_dev.sign_map[i];
+	}
+	return count;
+}
+
+#else
+
+uint8_t accel_update(void)
+{
+	adxl345_read_accel();
+	for (uint8_t i=0; i<3; ++i)
+		s_accel[i] = adxl345_accel(i);
+	vib_sample(s_accel[VIB_AXIS]);
+	return 1;
+}
+
+#endif  // SENSOR_FIFO
+
+/*-----------------------------------------------------------------------*/
+
+int16_t accel_value(uint8_t axis)
+{
+	return s_accel[axis];
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t accel_overruns(void)
+{
+	return s_overruns;
+}
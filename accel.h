@@ -0,0 +1,57 @@
+#ifndef ACCEL_H_
+#define ACCEL_H_
+
+#include <inttypes.h>
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * accelerometer acquisition
+ *
+ * accel_update() runs from the 80hz task and leaves the sample in
+ * body axes, through the axis and sign maps of g_adxl345_dev.
+ *
+ * with SENSOR_FIFO the adxl345 samples at ACCEL_BW_RATE into its 32
+ * deep FIFO in stream mode. Its INT1 and INT2 aren't wired to the mcu,
+ * so in place of a watermark interrupt the task empties it, one 8 byte
+ * i2c burst per sample that ends with FIFO_STATUS, the entries still
+ * waiting. Every sample read is averaged, 2 or 3 at 200hz. More than
+ * ACCEL_FIFO_MAX waiting (the task was held up) would keep the bus too
+ * long, the FIFO is then cleared and only the newest sample taken,
+ * counted as an overrun.
+ *
+ * without SENSOR_FIFO every update reads one sample through the
+ * driver.
+ *
+ * every sample read goes to the vibration monitor at ACCEL_SAMPLE_HZ,
+ * a cleared FIFO restarts its block.
+ */
+
+// adxl345 BW_RATE output data rate code, 0x0b is 200hz
+#define ACCEL_BW_RATE     0x0B
+
+// most samples read out in one update, two 80hz frames at 200hz
+#define ACCEL_FIFO_MAX    5
+
+// rate of the samples handed to vib_sample()
+#ifdef SENSOR_FIFO
+#define ACCEL_SAMPLE_HZ   200
+#else
+#define ACCEL_SAMPLE_HZ   80
+#endif
+
+// setup the FIFO, after adxl345_init(), returns 1 if the adxl345
+// doesn't answer
+extern uint8_t accel_init(void);
+
+// read the new samples into the current accelerations
+// returns the number of samples averaged, 0 if they are stale
+extern uint8_t accel_update(void);
+
+// current acceleration in raw counts, longitudinal, lateral, normal
+extern int16_t accel_value(uint8_t axis);
+
+// number of times the FIFO was cleared because it was too full
+extern uint16_t accel_overruns(void);
+
+#endif  // ACCEL_H_
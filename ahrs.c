@@ -19,25 +19,42 @@
  */
 
 #include "defs.h"
-#include <avr/interrupt.h>
 #include <avr/pgmspace.h>
-#include <util/delay.h>
 #include <stdio.h>
 #include "uart.h"
 #include "i2cmaster.h"
 #include "gpio.h"
+#include "hal.h"
 #include "timer.h"
 #include "timer1.h"
 #include "spi.h"
 #include "bmp085.h"
+#include "baro.h"
 #include "adxl345.h"
 #include "l3g4200d.h"
+#include "gyro.h"
+#include "accel.h"
+#include "attitude.h"
+#include "airdata.h"
+#include "filter.h"
+#include "vib.h"
 #include "canaero.h"
 #include "canaeromsg.h"
 #include "canaero_filters.h"
 #include "at90can.h"
 #include "globals.h"
 #include "watchdog.h"
+#include "sched.h"
+#include "prof.h"
+#include "jitter.h"
+#include "stackmon.h"
+#include "trace.h"
+#include "telem.h"
+#include "calib.h"
+#include "config.h"
+#ifdef BENCH
+#include "bench/bench.h"
+#endif
 
 /*-----------------------------------------------------------------------*/
 
@@ -47,39 +64,18 @@
 //#define USE_GYRO 1
 // ----------------
 
-// set serial port to stdio
-static FILE uart_ostr = FDEV_SETUP_STREAM(uart_putchar, NULL, _FDEV_SETUP_WRITE);
-static FILE uart_istr = FDEV_SETUP_STREAM(NULL, uart_getchar, _FDEV_SETUP_READ);
-
-// timer flags
-
-// 20 hz timer flag
-volatile uint8_t g_timer20_set;
-const uint8_t k_timer20_compare_count = 4;
-
-// 80 hz timer flag
-volatile uint8_t g_timer80_set;
-
-/*-----------------------------------------------------------------------*/
-
 void timer1_compareA(void)
 {
-	g_timer80_set = 1;
-    // every 'k_timer20_compare_count' compare match events is an 20 hz tick
-    static uint8_t timer20_count;
-	if (++timer20_count == k_timer20_compare_count)
-    {
-		timer20_count = 0;
-		g_timer20_set = 1;
-    }
+	// every compare match is a scheduler tick
+	sched_tick();
 }
 
 static timer1_init_t timer1_settings = {
     .scale = CLK8,
     .compareA_cb = timer1_compareA,
     .compareB_cb = 0,
-    // compare A triggers at 80Hz
-    .compareA_val = (F_CPU / 80 / 8),
+    // compare A triggers at the scheduler tick rate
+    .compareA_val = (F_CPU / SCHED_TICK_HZ / 8),
     .compareB_val = 0,
 };
 
@@ -132,42 +128,20 @@ uint8_t rx_fifo_buffer[RX_FIFO_BUFFER_SIZE];
 
 void led1_on(void)
 {
-	PORT_LED1 |= _BV(P_LED1);
+	hal_led_on(1);
 }
 void led1_off(void)
 {
-	PORT_LED1 &= ~_BV(P_LED1);
+	hal_led_off(1);
 }
 
 void led2_on(void)
 {
-	PORT_LED2 |= _BV(P_LED2);
+	hal_led_on(2);
 }
 void led2_off(void)
 {
-	PORT_LED2 &= ~_BV(P_LED2);
-}
-
-/*-----------------------------------------------------------------------*/
-
-// select the bmp085 device for reset
-inline static void xclr_low(int device)
-{
-    if (device == 0)
-        PORT_XCLR1 &= ~(_BV(P_XCLR1));
-    else
-        PORT_XCLR2 &= ~(_BV(P_XCLR2));
-}
-
-/*-----------------------------------------------------------------------*/
-
-// select the bmp085 device for I2C
-inline static void xclr_hi(int device)
-{
-    if (device == 0)
-        PORT_XCLR1 |= _BV(P_XCLR1);
-    else
-        PORT_XCLR2 |= _BV(P_XCLR2);
+	hal_led_off(2);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -179,12 +153,12 @@ void
 offline(void)
 {
 	uint8_t on = 1;
+	uint8_t last = g_sched_ticks;
 	led1_on();
 	while (1) {
 		// 10 hz timer
-		if (g_timer20_set)
+		if (sched_elapsed(&last, SCHED_PERIOD(20)))
 		{
-			g_timer20_set = 0;
 			if (on)
 				led1_off();
 			else
@@ -204,17 +178,17 @@ failed(uint8_t err)
 	errcode = err;
 	uint8_t count = 0;
 	uint8_t pause = 0;
+	uint8_t last = g_sched_ticks;
 	led1_off();
 	led2_on();
 	while (1) {
 		// 20 hz timer
-		if (g_timer20_set)
+		if (sched_elapsed(&last, SCHED_PERIOD(20)))
 		{
-			g_timer20_set = 0;
 			if (pause) {
 				--pause;
 			} else {
-				if (bit_is_set(count, 0))
+				if (count & 1)
 					led2_off();
 				else
 					led2_on();
@@ -231,8 +205,7 @@ failed(uint8_t err)
 
 static void can_error(struct can_device* dev, const can_error_t* err)
 {
-	printf_P(PSTR("*** can error:%d %d %d\n"), err->error_code, err->dev_buffer,
-			 err->dev_code);
+	trace(TRACE_CAN_ERROR, err->error_code, err->dev_buffer, err->dev_code);
 	if (err->error_code == CAN_BUS_OFF)
 		g_state = AHRSLISTEN;
 	else if (err->error_code == CAN_BUS_PASSIVE)
@@ -246,11 +219,10 @@ static void canaero_emergency_event(const struct emerg_event* ee)
 	if (ee->error_code == DISPLAY_BUFFER_OVERFLOW) {
 		g_state = AHRSLISTEN;
 		can_clear_tx_buffers(&at90can_dev);
-		puts_P(PSTR("EE:switching to listen mode"));
+		trace(TRACE_LISTEN, 0, 0, 0);
 	}
-	printf_P(PSTR("EE(%u):%d %d %d\n"), ee->node, ee->error_code,
-			 ee->operation_id,
-			 ee->location_id);
+	trace(TRACE_EMERGENCY, ee->node, ee->error_code,
+		  ((uint16_t)ee->operation_id << 8) | (uint8_t)ee->location_id);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -258,10 +230,11 @@ static void canaero_emergency_event(const struct emerg_event* ee)
 void
 system_start(void)
 {
-    // first set the clock prescaler change enable
-	CLKPR = _BV(CLKPCE);
-	// now set the clock prescaler to clk / 2
-	CLKPR = _BV(CLKPS0);
+	// fill the free ram for the stack high water mark
+	stackmon_paint();
+
+	// clk / 2
+	hal_clock_init();
 
 	watchdog_init(WDTO_1S);
 }
@@ -293,6 +266,10 @@ ioinit(void)
 			 HARDWARE_REVISION, APP_VERSION_MAJOR, APP_VERSION_MINOR);
 	led2_off();
 	
+	// settings saved over MCS
+	if (config_init())
+		puts_P(PSTR("config defaults."));
+	
 	// spi needs to be setup first
 	if (spi_init(4) == SPI_FAILED)
 		offline();
@@ -318,7 +295,10 @@ ioinit(void)
 	// set the error function
 	at90can_dev.handle_error_fn = can_error;
 	
-	canaero_high_priority_service_filters(&CAN_config);
+	if (g_config.filtering)
+		canaero_high_priority_service_filters(&CAN_config);
+	else
+		canaero_no_filters(&CAN_config);
 	
 	// now do the CAN stack
 	errcode = canaero_init(&CAN_config, &at90can_dev);
@@ -336,16 +316,7 @@ ioinit(void)
 	
     // setup the static, dynamic pressure devices
 	for (int i=0; i<2; ++i) {
-		switch (i) {
-		case 0:
-			xclr_hi(0);
-			xclr_low(1);
-			break;
-		case 1:
-			xclr_low(0);
-			xclr_hi(1);
-			break;
-		}
+		baro_select(i);
 		
 		struct bmp085_dev_t* p = &g_bmp085_data[i];
 		p->num = i;
@@ -359,15 +330,19 @@ ioinit(void)
 			failed(1);
 		puts_P(PSTR("bmp085 self-test complete."));
 	}
-	xclr_hi(0);
+	baro_release();
+
+	// pressures are read asynchronously from now on
+	if (baro_init())
+		failed(1);
 	
-	g_static_air_enabled = 1;
-	g_dynamic_air_enabled = 1;
+	g_static_air_enabled = g_config.static_air_enabled;
+	g_dynamic_air_enabled = g_config.dynamic_air_enabled;
 
 #ifdef USE_ACCEL
     // setup the accelerometer
 	adxl345_init(&g_adxl345_dev);
-	g_accelerometer_enabled = 1;
+	g_accelerometer_enabled = g_config.accel_enabled;
 	
 	puts_P(PSTR("adxl345 initialized."));
 	
@@ -376,6 +351,9 @@ ioinit(void)
 		failed(2);
 	adxl345_internal_self_test();
 	puts_P(PSTR("adxl345 self-test complete."));
+	// FIFO, if used, after the self test changed the settings
+	if (accel_init())
+		failed(2);
 
 #else
 	g_accelerometer_enabled = 0;
@@ -387,11 +365,28 @@ ioinit(void)
 	puts_P(PSTR("gyro initialized."));
 	l3g4200d_self_test();
 	puts_P(PSTR("gyro self-test complete."));
-	g_gyros_enabled = 1;
+	g_gyros_enabled = g_config.gyros_enabled;
+	// samples are read on DRDY, or the FIFO watermark, from now on
+	gyro_init();
 #else
 	g_gyros_enabled = 0;
 #endif
 
+	// sensor calibration, raw counts are used without it
+	if (calib_init())
+		puts_P(PSTR("no sensor calibration."));
+
+	attitude_init();
+	airdata_init();
+	filter_init();
+	vib_init();
+
+	// message output rates
+	nod_init();
+
+	// raw sample stream
+	telem_enable(g_config.telemetry);
+
 	watchdog_print_flags();
 	
 	// led off when ioinit done
@@ -403,101 +398,194 @@ ioinit(void)
 
 /*-----------------------------------------------------------------------*/
 
+// 80 hz task, inertial sensors and all the messages
+static void
+task_80hz(void)
+{
+	// keep track of the last time
+	static uint32_t lt;
+
+//	puts_P(PSTR("80hz"));
+	// find the current time in tenth ms
+	uint32_t ct = jiffie();
+	prof_time_t t;
+#ifdef USE_GYRO
+	// average the samples captured since the last tick
+	if (g_gyros_enabled) {
+		t = prof_begin();
+		gyro_update();
+		prof_end(PROF_GYRO, t);
+	}
+#endif
+#ifdef USE_ACCEL
+	if (g_accelerometer_enabled) {
+		t = prof_begin();
+		accel_update();
+		prof_end(PROF_ACCEL, t);
+	}
+#endif
+	// bias, scale and misalignment at the board temperature
+	int16_t gyro[3], accel[3];
+	for (uint8_t i=0; i<3; ++i) {
+		gyro[i] = gyro_rate(i);
+		accel[i] = accel_value(i);
+	}
+	// the bias at CALIB_TREF until a pressure chip has a temperature
+	int16_t temp = CALIB_TREF;
+	baro_board_temperature(&temp);
+	calib_update(gyro, accel, temp);
+	// the message filters see the calibrated samples
+	for (uint8_t i=0; i<3; ++i) {
+		filter_sample(FILTER_LONG_ACCEL + i, calib_accel(i));
+		filter_sample(FILTER_PITCH_RATE + i, calib_gyro(i));
+	}
+#if defined(USE_GYRO) && defined(USE_ACCEL)
+	// attitude estimator needs both sensors
+	if (g_gyros_enabled && g_accelerometer_enabled) {
+		t = prof_begin();
+		for (uint8_t i=0; i<3; ++i) {
+			gyro[i] = calib_gyro(i);
+			accel[i] = calib_accel(i);
+		}
+		attitude_update(gyro, accel);
+		prof_end(PROF_ATTITUDE, t);
+	}
+#endif
+	// raw samples to the uart, if streaming
+	telem_frame();
+
+	// calc the elapsed time in tenth ms
+	g_cycle_time = timer_elapsed(lt, ct);
+	// reset the last time
+	lt = ct;
+//	puts_P(PSTR("end 80hz"));
+	if(g_state == AHRSACTIVE) {
+		t = prof_begin();
+		nod_send_messages(NOD_CYCLE_FIRST, NOD_CYCLE_END);
+		prof_end(PROF_SEND_CYCLE, t);
+#ifdef USE_GYRO
+		t = prof_begin();
+		if (g_config.compact_nod)
+			nod_send_messages(NOD_COMPACT_GYRO_FIRST, NOD_COMPACT_GYRO_END);
+		else
+			nod_send_messages(NOD_GYRO_FIRST, NOD_GYRO_END);
+		prof_end(PROF_SEND_GYRO, t);
+#endif
+#ifdef USE_ACCEL
+		t = prof_begin();
+		if (g_config.compact_nod)
+			nod_send_messages(NOD_COMPACT_ACCEL_FIRST, NOD_COMPACT_ACCEL_END);
+		else
+			nod_send_messages(NOD_ACCEL_FIRST, NOD_ACCEL_END);
+		nod_send_messages(NOD_VIBRATION_FIRST, NOD_VIBRATION_END);
+		prof_end(PROF_SEND_ACCEL, t);
+#endif
+#if defined(USE_GYRO) && defined(USE_ACCEL)
+		if (g_gyros_enabled && g_accelerometer_enabled) {
+			t = prof_begin();
+			nod_send_messages(NOD_ATTITUDE_FIRST, NOD_ATTITUDE_END);
+			prof_end(PROF_SEND_ATTITUDE, t);
+		}
+#endif
+		t = prof_begin();
+		nod_send_messages(NOD_PRESSURE_FIRST, NOD_PRESSURE_END);
+		nod_send_messages(NOD_AIRDATA_FIRST, NOD_AIRDATA_END);
+		prof_end(PROF_SEND_PRESSURE, t);
+	}
+	// frame period and execution time histograms
+	jitter_frame(ct, jiffie());
+}
+
+/*-----------------------------------------------------------------------*/
+
+// 20 hz task, pressure conversions and air data, they are sent with
+// the 80 hz messages at the rate set by their divider
+static void
+task_20hz(void)
+{
+//	puts_P(PSTR("20hz"));
+
+	// altitude and airspeed from the pressures collected since
+	prof_time_t t = prof_begin();
+	airdata_update();
+	prof_end(PROF_AIRDATA, t);
+
+	// start a conversion on the next pressure chip, the result is
+	// collected by baro_task()
+	t = prof_begin();
+	baro_start();
+	prof_end(PROF_BARO, t);
+
+//	puts_P(PSTR("end 20hz"));
+}
+
+/*-----------------------------------------------------------------------*/
+
+// the task table, in priority order
+// phases keep the 80 hz and 20 hz work on different ticks
+static const sched_task_t k_tasks[] PROGMEM = {
+	/* period, phase, budget (tenth ms), task */
+	{SCHED_PERIOD(80), 0, 40, task_80hz},
+	{SCHED_PERIOD(20), 1, 20, task_20hz},
+};
+STATIC_ASSERT(sched_tasks,
+			  sizeof(k_tasks) / sizeof(sched_task_t) <= SCHED_MAX_TASKS);
+
+/*-----------------------------------------------------------------------*/
+
 int
 main(void)
 {
-	int bmp_device = 0;
-
 	g_state = AHRSINIT;
 
 	system_start();
 
-	// stdout is the uart
-	stdout = &uart_ostr;
-	// stdin is the uart
-	stdin = &uart_istr;
+	// stdin and stdout are the uart
+	hal_console_init();
 	
     ioinit();
-	sei();
 
-	g_state = AHRSLISTEN;
+	sched_init(k_tasks, sizeof(k_tasks) / sizeof(sched_task_t));
+	hal_irq_enable();
+
+	// listen or active as it was last set
+	g_state = g_config.active ? AHRSACTIVE : AHRSLISTEN;
+
+#ifdef BENCH
+	// the benchmark image times the tasks instead, doesn't return
+	bench_run(task_80hz, task_20hz);
+#endif
 
-	// keep track of the last time
-	uint32_t lt = jiffie();
-	
     while(1)
     {
 		watchdog_reset();
 		
 		// write the eeprom if necessary
-		//canaero_write_eeprom_task();
+		config_task();
 
 		// check for can interrupt
-		if(canaero_handle_interrupt(&CAN_config) == CAN_INTERRUPT)
+		prof_time_t t = prof_begin();
+		if(canaero_handle_interrupt(&CAN_config) == CAN_INTERRUPT) {
 			canaero_poll_messages(&CAN_config);
-		
-        // 80 hz timer
-        if (g_timer80_set)
-        {
-            g_timer80_set = 0;
-//			puts_P(PSTR("80hz"));
-			// find the current time in tenth ms
-			uint32_t ct = jiffie();
-#ifdef USE_GYRO
-			// read the data
-			if (g_gyros_enabled)
-			 	l3g4200d_read_data(&g_gyro_dev);
-#endif
-#ifdef USE_ACCEL
-			if (g_accelerometer_enabled)
-				adxl345_read_accel();
-#endif
-			// calc the elapsed time in tenth ms
-			g_cycle_time = timer_elapsed(lt, ct);
-			// reset the last time
-			lt = ct;
-//			puts_P(PSTR("end 80hz"));
-			if(g_state == AHRSACTIVE) {
-				canaero_send_messages(&CAN_config, 0, 1);
-#ifdef USE_GYRO
-				canaero_send_messages(&CAN_config, 4, 7);
-#endif
-#ifdef USE_ACCEL
-				canaero_send_messages(&CAN_config, 1, 4);
-#endif
-			}
-        }
-
-        // 20 hz timer
-        if (g_timer20_set)
-        {
-            g_timer20_set = 0;
-//			puts_P(PSTR("20hz"));
-
-			// read the pressure chips
-			// reset the chip we aren't reading, so only one
-			// responds on i2c bus
-			if(bmp_device == 0)
-				xclr_low(1);
-			if(bmp_device == 1)
-				xclr_low(0);
-				
-			bmp085_read_data(&g_bmp085_data[bmp_device]);
-
-			// make sure both chips are not in reset, so they work
-			xclr_hi(0);
-			xclr_hi(1);
-
-			// next cycle, read the other chip
-			if(++bmp_device == 2)
-				bmp_device = 0;
-
-			if(g_state == AHRSACTIVE)
-				canaero_send_messages(&CAN_config, 7, 9);
-			
-//			puts_P(PSTR("end 20hz"));
-        }
+			prof_end(PROF_CAN, t);
+		}
+
+		// collect a finished pressure conversion
+		t = prof_begin();
+		if (baro_task())
+			prof_end(PROF_BARO, t);
+
+		// run the tasks released by the timer
+		sched_dispatch();
+
+		// vibration spectrum in the idle time before the next tick
+		vib_task();
+
+		// look for the stack high water mark
+		stackmon_scan();
 
+		// send the trace log while the uart is idle
+		trace_drain();
     }
     return 0;
 }
@@ -0,0 +1,208 @@
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+
+#include "airdata.h"
+#include "baro.h"
+#include "config.h"
+#include "fixmath.h"
+#include "globals.h"
+
+/*-----------------------------------------------------------------------*/
+
+// altitude table, first pressure and step in Pa
+#define ALT_TABLE_PRESS     22528L
+#define ALT_TABLE_SHIFT     10
+#define ALT_TABLE_SIZE      87
+
+// last pressure inside the table
+#define ALT_TABLE_END \
+	(ALT_TABLE_PRESS + ((ALT_TABLE_SIZE - 1L) << ALT_TABLE_SHIFT) - 1)
+
+// 2 / rho0 in cm^2/s^2 per Pa, rho0 = 1.225 kg/m^3
+#define IAS_SCALE           16327L
+
+// compressibility table step in Pa, as a shift, and the largest qc
+#define IAS_TABLE_SHIFT     11
+#define IAS_MAX_QC          32767L
+
+// ISA troposphere altitude in cm every 1024 Pa from 22528 Pa,
+// 4433077 * (1 - (p / 101325)^0.190263)
+static const int32_t k_alt_table[ALT_TABLE_SIZE] PROGMEM = {
+	1102920, 1074636, 1047330, 1020931, 995374, 970600,
+	946559, 923203, 900490, 878383, 856845, 835846,
+	815356, 795348, 775798, 756683, 737981, 719674,
+	701744, 684172, 666944, 650046, 633462, 617181,
+	601191, 585479, 570036, 554851, 539915, 525219,
+	510755, 496514, 482489, 468673, 455058, 441639,
+	428410, 415364, 402496, 389800, 377271, 364906,
+	352698, 340643, 328738, 316978, 305360, 293878,
+	282531, 271315, 260225, 249260, 238415, 227689,
+	217077, 206579, 196190, 185908, 175731, 165657,
+	155683, 145807, 136026, 126340, 116745, 107241,
+	97824, 88494, 79248, 70085, 61003, 52001,
+	43077, 34229, 25457, 16758, 8131, -424,
+	-8910, -17328, -25678, -33962, -42182, -50337,
+	-58430, -66461, -74432,
+};
+
+// compressible over incompressible airspeed in Q15 every 2048 Pa of qc,
+// a0 sqrt(5 ((qc / p0 + 1)^(2/7) - 1)) / sqrt(2 qc / rho0)
+static const uint16_t k_ias_table[17] PROGMEM = {
+	32768, 32651, 32536, 32423, 32312, 32204, 32097, 31992,
+	31889, 31788, 31688, 31590, 31493, 31398, 31305, 31213,
+	31122,
+};
+
+/*-----------------------------------------------------------------------*/
+
+// (101325 - QNH) / QNH in Q16, the static pressure correction
+static int32_t s_qnh_scale;
+
+// alpha-beta filter, altitude in cm and vertical speed in cm/s, Q8
+static int32_t s_alt_q8;
+static int32_t s_vs_q8;
+static uint8_t s_running;
+
+// results
+static int32_t s_altitude;
+static int32_t s_baro_altitude;
+static int16_t s_airspeed;
+static int16_t s_vertical_speed;
+
+/*-----------------------------------------------------------------------*/
+
+void airdata_init(void)
+{
+	if (airdata_set_qnh(g_config.qnh))
+		airdata_set_qnh(AIRDATA_QNH_STD);
+	s_running = 0;
+	s_altitude = 0;
+	s_baro_altitude = 0;
+	s_airspeed = 0;
+	s_vertical_speed = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t airdata_set_qnh(uint32_t qnh)
+{
+	if (qnh < AIRDATA_QNH_MIN || qnh > AIRDATA_QNH_MAX)
+		return 1;
+	// rounded, the correction adds under half a Pa
+	s_qnh_scale = (((int32_t)AIRDATA_QNH_STD - (int32_t)qnh) * 65536L
+				   + (int32_t)(qnh / 2)) / (int32_t)qnh;
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int32_t airdata_pressure_altitude(int32_t press)
+{
+	if (press < ALT_TABLE_PRESS)
+		press = ALT_TABLE_PRESS;
+	else if (press > ALT_TABLE_END)
+		press = ALT_TABLE_END;
+
+	uint32_t offset = press - ALT_TABLE_PRESS;
+	uint8_t idx = offset >> ALT_TABLE_SHIFT;
+	uint16_t frac = offset & ((1 << ALT_TABLE_SHIFT) - 1);
+	int32_t h0 = pgm_read_dword(&k_alt_table[idx]);
+	int32_t h1 = pgm_read_dword(&k_alt_table[idx + 1]);
+	return h0 + (((h1 - h0) * frac) >> ALT_TABLE_SHIFT);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t airdata_ias(int32_t qc)
+{
+	if (qc <= 0)
+		return 0;
+	if (qc > IAS_MAX_QC)
+		qc = IAS_MAX_QC;
+
+	// incompressible airspeed, then the compressibility factor
+	uint16_t v = fix_isqrt32((uint32_t)qc * IAS_SCALE);
+	uint8_t idx = qc >> IAS_TABLE_SHIFT;
+	uint16_t frac = qc & ((1 << IAS_TABLE_SHIFT) - 1);
+	uint16_t s0 = pgm_read_word(&k_ias_table[idx]);
+	int16_t ds = pgm_read_word(&k_ias_table[idx + 1]) - s0;
+	uint16_t s = s0 + (int16_t)(((int32_t)ds * frac) >> IAS_TABLE_SHIFT);
+	return (int16_t)(((uint32_t)v * s) >> 15);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// alpha-beta step with a new altitude in cm
+static void airdata_vs_update(int32_t alt)
+{
+	int32_t pred = s_alt_q8 + s_vs_q8 / AIRDATA_SAMPLE_HZ;
+	int32_t r = alt * 256 - pred;
+
+	// first sample, or a jump the filter would take long to follow
+	if (!s_running || r > AIRDATA_RESET_CM * 256
+		|| r < -AIRDATA_RESET_CM * 256) {
+		s_alt_q8 = alt * 256;
+		s_vs_q8 = 0;
+		s_running = 1;
+	} else {
+		s_alt_q8 = pred + (r >> AIRDATA_ALT_SHIFT);
+		s_vs_q8 += (r * AIRDATA_SAMPLE_HZ) >> AIRDATA_VS_SHIFT;
+	}
+
+	int32_t vs = s_vs_q8 >> 8;
+	if (vs > INT16_MAX)
+		vs = INT16_MAX;
+	else if (vs < -INT16_MAX)
+		vs = -INT16_MAX;
+	s_vertical_speed = vs;
+}
+
+void airdata_update(void)
+{
+	int32_t ps = g_bmp085_data[0].press;
+
+	if (baro_fresh(0) && g_static_air_enabled) {
+		s_altitude = airdata_pressure_altitude(ps);
+		// keeps the correction product in range, the table ends there
+		int32_t p = (ps > ALT_TABLE_END) ? ALT_TABLE_END : ps;
+		s_baro_altitude = airdata_pressure_altitude(
+			p + ((p * s_qnh_scale + 32768L) >> 16));
+		airdata_vs_update(s_altitude);
+	}
+
+	if (baro_fresh(1) && g_dynamic_air_enabled)
+		s_airspeed = airdata_ias(g_bmp085_data[1].press - ps);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int32_t airdata_altitude(void)
+{
+	return s_altitude;
+}
+
+int32_t airdata_baro_altitude(void)
+{
+	return s_baro_altitude;
+}
+
+int16_t airdata_airspeed(void)
+{
+	return s_airspeed;
+}
+
+int16_t airdata_vertical_speed(void)
+{
+	return s_vertical_speed;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void airdata_mis_qnh_data(can_msg_t* msg)
+{
+	uint32_t qnh = g_config.qnh;
+	msg->data[4] = (uint8_t)(qnh >> 24);
+	msg->data[5] = (uint8_t)(qnh >> 16);
+	msg->data[6] = (uint8_t)(qnh >> 8);
+	msg->data[7] = (uint8_t)qnh;
+}
@@ -0,0 +1,85 @@
+#ifndef AIRDATA_H_
+#define AIRDATA_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * air data computer, integer only
+ *
+ * pressure altitude, baro corrected altitude, indicated airspeed and
+ * vertical speed from the static (device 0) and total (device 1)
+ * bmp085 pressures. airdata_update() runs from the 20hz task and
+ * takes a pressure when baro_fresh() says a new one is there, each
+ * device delivers at AIRDATA_SAMPLE_HZ.
+ *
+ * altitude is the ISA troposphere, a table of altitude against
+ * pressure every 1024 Pa with linear interpolation. The error is
+ * below 0.14 m down to 800 hPa (2 km), 0.27 m down to 540 hPa (5 km)
+ * and 1.3 m at the 225 hPa end (11 km). Beyond the table the
+ * altitude holds at the end value.
+ *
+ * the baro corrected altitude scales the static pressure by
+ * 101325 / QNH before the table, the same formula as a kollsman
+ * window. The correction rounds to a Pa and adds up to 0.1 m to the
+ * errors above. QNH is set with MCS code AIRDATA_MCS_QNH, in Pa, and
+ * kept in the config.
+ *
+ * indicated airspeed is the subsonic compressible formula for the
+ * sea level ISA, sqrt(2 qc / rho0) times a compressibility factor
+ * table every 2048 Pa of qc, within 3 cm/s up to 32767 Pa (220 m/s).
+ * A negative qc is 0.
+ *
+ * vertical speed is an alpha-beta filter on the pressure altitude,
+ * gains 1 / 2^AIRDATA_ALT_SHIFT and 1 / 2^AIRDATA_VS_SHIFT, ~2 s to
+ * follow a step in climb rate, ~8 cm/s rms from the sensor noise.
+ *
+ * units are cm and cm/s, the NOD payloads with FLOAT_NOD_DATA are
+ * m and m/s
+ */
+
+// rate of new pressures from each device, the 20hz task alternates
+#define AIRDATA_SAMPLE_HZ       10
+
+// alpha-beta filter gains as shifts
+#define AIRDATA_ALT_SHIFT       3
+#define AIRDATA_VS_SHIFT        6
+
+// an altitude this far off the filter restarts it, cm
+#define AIRDATA_RESET_CM        10000L
+
+// QNH limits and default, Pa
+#define AIRDATA_QNH_MIN         80000UL
+#define AIRDATA_QNH_MAX         110000UL
+#define AIRDATA_QNH_STD         101325UL
+
+// service codes
+#define AIRDATA_MCS_QNH         17
+#define AIRDATA_MIS_QNH         17
+
+// start over, uses the QNH of the config
+extern void airdata_init(void);
+
+// take the new pressures, if any, called from the 20hz task
+extern void airdata_update(void);
+
+// set QNH in Pa, returns 1 if it is out of range
+extern uint8_t airdata_set_qnh(uint32_t qnh);
+
+// ISA pressure altitude in cm of a pressure in Pa
+extern int32_t airdata_pressure_altitude(int32_t press);
+
+// indicated airspeed in cm/s of an impact pressure qc in Pa
+extern int16_t airdata_ias(int32_t qc);
+
+// last results
+extern int32_t airdata_altitude(void);
+extern int32_t airdata_baro_altitude(void);
+extern int16_t airdata_airspeed(void);
+extern int16_t airdata_vertical_speed(void);
+
+// MIS/MCS data, ULONG QNH in Pa
+extern void airdata_mis_qnh_data(can_msg_t* msg);
+
+#endif  // AIRDATA_H_
@@ -0,0 +1,130 @@
+#include <inttypes.h>
+
+#include "attitude.h"
+#include "fixmath.h"
+
+/*-----------------------------------------------------------------------*/
+
+// bam32 increment for one count of gyro rate over one update period
+#define ATT_GYRO_STEP ((int32_t)((GYRO_UDPS_PER_LSB * 4294967296LL \
+	+ 360000000LL * ATT_UPDATE_HZ / 2) / (360000000LL * ATT_UPDATE_HZ)))
+
+// accelerometer magnitude window for corrections, 0.75g .. 1.25g squared
+#define ATT_ACCEL_MIN_SQ (ACCEL_LSB_PER_G * ACCEL_LSB_PER_G * 9 / 16)
+#define ATT_ACCEL_MAX_SQ (ACCEL_LSB_PER_G * ACCEL_LSB_PER_G * 25 / 16)
+
+// smallest cos(pitch) used in the kinematics, ~88 degrees
+#define ATT_MIN_COS_PITCH 1024
+
+// largest euler rate in counts, keeps the bam32 increment in range
+#define ATT_MAX_RATE 65535L
+
+// pitch is limited to +-90 degrees
+#define ATT_PITCH_LIMIT 0x40000000L
+
+/*-----------------------------------------------------------------------*/
+
+// euler angles as bam32
+static int32_t s_angle[3];
+
+// set when roll and pitch have been initialized from the accels
+static uint8_t s_leveled;
+
+/*-----------------------------------------------------------------------*/
+
+static int32_t clamp_rate(int32_t rate)
+{
+	if (rate > ATT_MAX_RATE)
+		return ATT_MAX_RATE;
+	if (rate < -ATT_MAX_RATE)
+		return -ATT_MAX_RATE;
+	return rate;
+}
+
+// add a signed increment, wrapping at 360 degrees
+static int32_t wrap_add(int32_t angle, int32_t inc)
+{
+	return (int32_t)((uint32_t)angle + (uint32_t)inc);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void attitude_init(void)
+{
+	s_angle[ATT_ROLL] = 0;
+	s_angle[ATT_PITCH] = 0;
+	s_angle[ATT_HEADING] = 0;
+	s_leveled = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void attitude_update(const int16_t gyro[3], const int16_t accel[3])
+{
+	int32_t p = gyro[1];
+	int32_t q = gyro[0];
+	int32_t r = gyro[2];
+	int32_t ax = accel[0];
+	int32_t ay = accel[1];
+	int32_t az = accel[2];
+
+	// gravity reference, z is down so level flight reads -1g on z
+	int32_t n2 = ax * ax + ay * ay + az * az;
+	int32_t roll_ref = fix_atan2(-ay, -az);
+	int32_t pitch_ref = fix_atan2(ax, fix_isqrt32(ay * ay + az * az));
+
+	if (!s_leveled) {
+		s_angle[ATT_ROLL] = roll_ref;
+		s_angle[ATT_PITCH] = pitch_ref;
+		s_leveled = 1;
+	}
+
+	// body rates to euler rates
+	int16_t sphi, cphi, sth, cth;
+	fix_sincos((uint32_t)s_angle[ATT_ROLL] >> 16, &sphi, &cphi);
+	fix_sincos((uint32_t)s_angle[ATT_PITCH] >> 16, &sth, &cth);
+	if (cth < ATT_MIN_COS_PITCH)
+		cth = ATT_MIN_COS_PITCH;
+
+	int32_t w = ((q * sphi) >> 15) + ((r * cphi) >> 15);
+	int32_t roll_rate = clamp_rate(p + (w * sth) / cth);
+	int32_t pitch_rate = clamp_rate(((q * cphi) >> 15) - ((r * sphi) >> 15));
+	int32_t yaw_rate = clamp_rate((w << 15) / cth);
+
+	s_angle[ATT_ROLL] = wrap_add(s_angle[ATT_ROLL], roll_rate * ATT_GYRO_STEP);
+	s_angle[ATT_PITCH] = wrap_add(s_angle[ATT_PITCH], pitch_rate * ATT_GYRO_STEP);
+	s_angle[ATT_HEADING] = wrap_add(s_angle[ATT_HEADING], yaw_rate * ATT_GYRO_STEP);
+
+	// pull roll and pitch towards gravity, unless we are maneuvering
+	if (n2 > ATT_ACCEL_MIN_SQ && n2 < ATT_ACCEL_MAX_SQ) {
+		int32_t err = wrap_add(roll_ref, -s_angle[ATT_ROLL]);
+		s_angle[ATT_ROLL] = wrap_add(s_angle[ATT_ROLL], err >> ATT_ACCEL_GAIN_SHIFT);
+		err = wrap_add(pitch_ref, -s_angle[ATT_PITCH]);
+		s_angle[ATT_PITCH] = wrap_add(s_angle[ATT_PITCH], err >> ATT_ACCEL_GAIN_SHIFT);
+	}
+
+	// pitch integration can't go over the top
+	if (s_angle[ATT_PITCH] > ATT_PITCH_LIMIT)
+		s_angle[ATT_PITCH] = ATT_PITCH_LIMIT;
+	else if (s_angle[ATT_PITCH] < -ATT_PITCH_LIMIT)
+		s_angle[ATT_PITCH] = -ATT_PITCH_LIMIT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t attitude_angle(enum attitude_axis axis)
+{
+	return (int16_t)(s_angle[axis] >> 16);
+}
+
+/*-----------------------------------------------------------------------*/
+
+#ifdef FLOAT_NOD_DATA
+float attitude_degrees(enum attitude_axis axis)
+{
+	// heading is reported 0..360, roll and pitch signed
+	if (axis == ATT_HEADING)
+		return (uint16_t)attitude_angle(axis) * (360.0f / 65536.0f);
+	return attitude_angle(axis) * (360.0f / 65536.0f);
+}
+#endif
@@ -0,0 +1,45 @@
+#ifndef ATTITUDE_H_
+#define ATTITUDE_H_
+
+#include <inttypes.h>
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * complementary filter attitude estimator, integer only
+ *
+ * the gyro rates are integrated through the euler kinematics every
+ * 80hz tick, roll and pitch are pulled towards the accelerometer
+ * gravity vector. There is no magnetometer, so heading is integrated
+ * yaw rate only and will drift.
+ *
+ * inputs are the calibrated counts from calib_gyro() and calib_accel()
+ */
+
+// update rate of the estimator
+#define ATT_UPDATE_HZ            80
+
+// accelerometer correction gain as a shift, time constant is
+// 2^ATT_ACCEL_GAIN_SHIFT / ATT_UPDATE_HZ seconds
+#define ATT_ACCEL_GAIN_SHIFT     6
+
+// euler angle index
+enum attitude_axis {ATT_ROLL, ATT_PITCH, ATT_HEADING};
+
+// initialize the estimator, first update will level from the accels
+extern void attitude_init(void);
+
+// run one filter step
+// gyro is pitch, roll, yaw rate in counts
+// accel is longitudinal, lateral, normal in counts
+extern void attitude_update(const int16_t gyro[3], const int16_t accel[3]);
+
+// the euler angle as a bam16 (360/65536 degrees per lsb)
+extern int16_t attitude_angle(enum attitude_axis axis);
+
+#ifdef FLOAT_NOD_DATA
+// the euler angle in degrees
+extern float attitude_degrees(enum attitude_axis axis);
+#endif
+
+#endif  // ATTITUDE_H_
@@ -0,0 +1,288 @@
+#include <inttypes.h>
+#include "baro.h"
+#include "filter.h"
+#include "globals.h"
+#include "hal.h"
+#include "i2cmaster.h"
+#include "timer.h"
+
+/*-----------------------------------------------------------------------*/
+
+// bmp085 registers
+#define BMP085_CAL_AC1      0xAA
+#define BMP085_CONTROL      0xF4
+#define BMP085_DATA         0xF6
+#define BMP085_CMD_TEMP     0x2E
+#define BMP085_CMD_PRESS    (0x34 + (BARO_OSS << 6))
+
+// datasheet maximum conversion times in tenth ms
+#define BARO_TEMP_TIMEOUT   45
+#define BARO_PRESS_TIMEOUT  ((3 << BARO_OSS) * 10 + 15)
+
+// calibration coefficients from the device eeprom
+struct baro_cal {
+	int16_t ac1, ac2, ac3;
+	uint16_t ac4, ac5, ac6;
+	int16_t b1, b2, mb, mc, md;
+};
+
+static struct baro_cal s_cal[2];
+
+// state machine
+static enum baro_state s_state;
+static uint8_t s_device;
+static uint32_t s_start_time;
+static int32_t s_b5;
+static int16_t s_temp[2];
+static uint16_t s_timeouts;
+static uint8_t s_fresh;         // bit per device, new pressure
+static uint8_t s_have_temp;     // bit per device, s_temp is valid
+
+// set by the EOC interrupt
+static volatile uint8_t s_eoc;
+
+/*-----------------------------------------------------------------------*/
+
+ISR(INT4_vect)
+{
+	s_eoc = 1;
+}
+
+ISR(INT5_vect)
+{
+	s_eoc = 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void baro_select(uint8_t device)
+{
+	// the other one is held in reset, so only one answers
+	hal_baro_enable(device == 0 ? 1 : 2);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void baro_release(void)
+{
+	hal_baro_enable(3);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t baro_write(uint8_t reg, uint8_t val)
+{
+	if (i2c_start(BMP085_I2C_ADDRESS + I2C_WRITE)) {
+		i2c_stop();
+		return 1;
+	}
+	i2c_write(reg);
+	i2c_write(val);
+	i2c_stop();
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t baro_read(uint8_t reg, uint8_t* buf, uint8_t len)
+{
+	if (i2c_start(BMP085_I2C_ADDRESS + I2C_WRITE)) {
+		i2c_stop();
+		return 1;
+	}
+	i2c_write(reg);
+	i2c_rep_start(BMP085_I2C_ADDRESS + I2C_READ);
+	while (--len)
+		*buf++ = i2c_readAck();
+	*buf = i2c_readNak();
+	i2c_stop();
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t baro_init(void)
+{
+	uint8_t buf[22];
+
+	for (uint8_t i=0; i<2; ++i) {
+		baro_select(i);
+		if (baro_read(BMP085_CAL_AC1, buf, sizeof(buf))) {
+			baro_release();
+			return 1;
+		}
+		// 11 big endian words, in the order of the struct
+		uint16_t* p = (uint16_t*)&s_cal[i];
+		for (uint8_t j=0; j<11; ++j)
+			p[j] = ((uint16_t)buf[j * 2] << 8) | buf[j * 2 + 1];
+	}
+	baro_release();
+
+	s_state = BARO_IDLE;
+	s_device = 1;
+
+	// EOC rising edge on INT4 and INT5, enabled per conversion
+	hal_extint_rising(P_EOC1);
+	hal_extint_rising(P_EOC2);
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// device didn't answer, give up this cycle
+static void baro_abort(void)
+{
+	hal_extint_disable(P_EOC1);
+	hal_extint_disable(P_EOC2);
+	baro_release();
+	s_state = BARO_IDLE;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// begin a conversion on the selected device
+static void baro_convert(uint8_t cmd, enum baro_state next)
+{
+	s_eoc = 0;
+	hal_extint_arm((s_device == 0) ? P_EOC1 : P_EOC2);
+	if (baro_write(BMP085_CONTROL, cmd)) {
+		baro_abort();
+		return;
+	}
+	s_start_time = jiffie();
+	s_state = next;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void baro_start(void)
+{
+	if (s_state != BARO_IDLE)
+		return;
+
+	// alternate between the static and total pressure device
+	s_device ^= 1;
+	baro_select(s_device);
+	baro_convert(BMP085_CMD_TEMP, BARO_TEMP);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// datasheet temperature compensation, keeps b5 for the pressure
+static int16_t baro_calc_temp(const struct baro_cal* c, int32_t ut)
+{
+	int32_t x1 = ((ut - c->ac6) * c->ac5) >> 15;
+	int32_t x2 = ((int32_t)c->mc << 11) / (x1 + c->md);
+	s_b5 = x1 + x2;
+	return (int16_t)((s_b5 + 8) >> 4);
+}
+
+// datasheet pressure compensation, result in Pa
+static int32_t baro_calc_press(const struct baro_cal* c, int32_t up)
+{
+	int32_t b6 = s_b5 - 4000;
+	int32_t b62 = (b6 * b6) >> 12;
+	int32_t x1 = ((int32_t)c->b2 * b62) >> 11;
+	int32_t x2 = ((int32_t)c->ac2 * b6) >> 11;
+	int32_t x3 = x1 + x2;
+	int32_t b3 = ((((int32_t)c->ac1 * 4 + x3) << BARO_OSS) + 2) / 4;
+	x1 = ((int32_t)c->ac3 * b6) >> 13;
+	x2 = ((int32_t)c->b1 * b62) >> 16;
+	x3 = ((x1 + x2) + 2) >> 2;
+	uint32_t b4 = ((uint32_t)c->ac4 * (uint32_t)(x3 + 32768)) >> 15;
+	uint32_t b7 = ((uint32_t)up - b3) * (50000UL >> BARO_OSS);
+	int32_t p;
+	if (b7 < 0x80000000UL)
+		p = (b7 * 2) / b4;
+	else
+		p = (b7 / b4) * 2;
+	x1 = (p >> 8) * (p >> 8);
+	x1 = (x1 * 3038) >> 16;
+	x2 = (-7357 * p) >> 16;
+	return p + ((x1 + x2 + 3791) >> 4);
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t baro_task(void)
+{
+	uint8_t buf[3];
+
+	if (s_state == BARO_IDLE)
+		return 0;
+
+	// wait for EOC, fall back on the maximum conversion time
+	uint16_t timeout = (s_state == BARO_TEMP) ? BARO_TEMP_TIMEOUT
+		: BARO_PRESS_TIMEOUT;
+	if (!s_eoc) {
+		if (timer_elapsed(s_start_time, jiffie()) < timeout)
+			return 0;
+		++s_timeouts;
+	}
+	hal_extint_disable(P_EOC1);
+	hal_extint_disable(P_EOC2);
+
+	const struct baro_cal* c = &s_cal[s_device];
+	if (s_state == BARO_TEMP) {
+		if (baro_read(BMP085_DATA, buf, 2)) {
+			baro_abort();
+			return 1;
+		}
+		int32_t ut = ((uint16_t)buf[0] << 8) | buf[1];
+		s_temp[s_device] = baro_calc_temp(c, ut);
+		s_have_temp |= 1 << s_device;
+		baro_convert(BMP085_CMD_PRESS, BARO_PRESS);
+		return 1;
+	}
+
+	if (baro_read(BMP085_DATA, buf, 3)) {
+		baro_abort();
+		return 1;
+	}
+	int32_t up = (((int32_t)buf[0] << 16) | ((uint16_t)buf[1] << 8) | buf[2])
+		>> (8 - BARO_OSS);
+	g_bmp085_data[s_device].press = baro_calc_press(c, up);
+	s_fresh |= 1 << s_device;
+	filter_sample(FILTER_STATIC_PRESS + s_device,
+				  g_bmp085_data[s_device].press);
+	baro_release();
+	s_state = BARO_IDLE;
+	return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t baro_temperature(uint8_t device)
+{
+	return s_temp[device];
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t baro_board_temperature(int16_t* temp)
+{
+	uint8_t device = 0;
+	if (!g_static_air_enabled || !(s_have_temp & 1))
+		device = 1;
+	if (!(s_have_temp & (1 << device)))
+		return 1;
+	*temp = s_temp[device];
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t baro_fresh(uint8_t device)
+{
+	uint8_t bit = 1 << device;
+	uint8_t fresh = s_fresh & bit;
+	s_fresh &= ~bit;
+	return fresh ? 1 : 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t baro_eoc_timeouts(void)
+{
+	return s_timeouts;
+}
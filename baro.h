@@ -0,0 +1,53 @@
+#ifndef BARO_H_
+#define BARO_H_
+
+#include <inttypes.h>
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * non-blocking acquisition for the two bmp085 pressure sensors
+ *
+ * baro_start() begins a temperature then pressure conversion on the
+ * next device and returns, baro_task() is run every pass of the main
+ * loop and only touches the i2c bus once the EOC interrupt (INT4 for
+ * device 0, INT5 for device 1) says the conversion is done, or the
+ * datasheet maximum conversion time has passed.
+ */
+
+// oversampling, must match the mode given to bmp085_init()
+#define BARO_OSS          1
+
+// state of the acquisition
+enum baro_state {BARO_IDLE, BARO_TEMP, BARO_PRESS};
+
+// hold the other device in reset so only 'device' answers on i2c
+extern void baro_select(uint8_t device);
+
+// take both devices out of reset
+extern void baro_release(void);
+
+// read the calibration coefficients, after bmp085_init()
+extern uint8_t baro_init(void);
+
+// start a conversion cycle on the next device, if idle
+extern void baro_start(void);
+
+// advance the state machine, returns 1 if it used the i2c bus
+extern uint8_t baro_task(void);
+
+// last temperature in 0.1 C
+extern int16_t baro_temperature(uint8_t device);
+
+// board temperature in 0.1 C into 'temp', of the static device, or of
+// the total one while the static is disabled or has none yet. Returns
+// 1 and leaves 'temp' as it is if neither has converted one
+extern uint8_t baro_board_temperature(int16_t* temp);
+
+// 1 once after a new pressure of 'device', then 0 until the next
+extern uint8_t baro_fresh(uint8_t device);
+
+// number of conversions that timed out waiting for EOC
+extern uint16_t baro_eoc_timeouts(void);
+
+#endif  // BARO_H_
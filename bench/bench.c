@@ -0,0 +1,359 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "bench.h"
+#include "defs.h"
+#include "globals.h"
+#include "canaero.h"
+#include "canaeromsg.h"
+#include "canaerospec.h"
+#include "baro.h"
+#include "stackmon.h"
+#include "telem.h"
+#include "prof.h"
+#include "jitter.h"
+#include "airdata.h"
+#include "filter.h"
+#include "fixmath.h"
+#include "fft.h"
+#include "gyro.h"
+#include "vib.h"
+
+/*-----------------------------------------------------------------------*/
+
+// timer3 overflows, the high word of the cycle count
+static volatile uint16_t s_wraps;
+
+// cost of a bare measurement, taken off every count
+static uint16_t s_overhead;
+
+// names of the NOD data functions, in template order
+#define BENCH_NOD_NAME(a, name, id, type, fn, value, range, div) #fn "\0"
+static const char k_nod_names[] PROGMEM = NOD_MESSAGES(BENCH_NOD_NAME, 0);
+
+// first code of each MIS and MCS entry
+#define BENCH_MIS_CODE(code, rep, count, type, fn, select) code,
+static const uint8_t k_mis_codes[] PROGMEM = {
+	MIS_SERVICES(BENCH_MIS_CODE)
+};
+
+// MCS requests in MCS_SERVICES order, each leaves the unit as the
+// benches need it, active with the sensors on and the default dividers
+static const struct {
+	uint8_t type;
+	uint8_t data[4];
+} k_mcs_requests[] PROGMEM = {
+	{UCHAR2,  {0, 0, 0, 0}},
+	{UCHAR2,  {0, 0, 0, 0}},
+	{UCHAR4,  {1, 1, 1, 1}},
+	{UCHAR,   {0, 0, 0, 0}},
+	{USHORT2, {0, NOD_LONG_ACCEL, 0, 0}},
+	{USHORT2, {0, NOD_LONG_ACCEL, 0, 0}},
+	{UCHAR2,  {NOD_LONG_ACCEL, 1, 0, 0}},
+	{UCHAR,   {0, 0, 0, 0}},
+	{ULONG,   {0x00, 0x01, 0x8b, 0xcd}},
+	{UCHAR4,  {FILTER_LONG_ACCEL, FILTER_NONE, 0, 0}},
+	{NODATA,  {0, 0, 0, 0}},
+	{NODATA,  {0, 0, 0, 0}},
+};
+
+#define BENCH_MCS_CODE(code, request, type, fn, set) code,
+static const uint8_t k_mcs_codes[] PROGMEM = {
+	MCS_SERVICES(BENCH_MCS_CODE)
+};
+
+STATIC_ASSERT(bench_mcs_requests, sizeof(k_mcs_requests)
+			  / sizeof(k_mcs_requests[0]) == sizeof(k_mcs_codes));
+
+// math kernel inputs and results, volatile so the calls aren't folded
+static volatile uint32_t s_in[BENCH_PASSES] = {
+	1, 77, 4095, 65536, 1000003, 0x00ffffffUL, 0x3fffffffUL, 0xffffffffUL,
+};
+static volatile uint32_t s_out;
+
+/*-----------------------------------------------------------------------*/
+
+ISR(TIMER3_OVF_vect)
+{
+	++s_wraps;
+}
+
+// cycles since the timer started
+static uint32_t bench_cycles(void)
+{
+	uint16_t lo, hi;
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		lo = TCNT3;
+		hi = s_wraps;
+		// wrapped since the interrupts went off
+		if ((TIFR3 & _BV(TOV3)) && lo < 0x8000)
+			++hi;
+	}
+	return ((uint32_t)hi << 16) | lo;
+}
+
+static uint32_t bench_since(uint32_t start)
+{
+	return bench_cycles() - start - s_overhead;
+}
+
+static void bench_print(const char* name, uint32_t cycles)
+{
+	printf_P(PSTR("bench %S %lu\n"), name, (unsigned long)cycles);
+}
+
+// the same with a code after the name
+static void bench_print_code(const char* prefix, uint8_t code, uint32_t cycles)
+{
+	printf_P(PSTR("bench %S_%u %lu\n"), prefix, code, (unsigned long)cycles);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// the interrupt lines are outputs, a rising edge written to the port
+// raises the interrupt as the sensor would
+static void bench_pulse(uint8_t pin)
+{
+	PORTE |= _BV(pin);
+	PORTE &= ~_BV(pin);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// one 80 hz frame, sensors, attitude and every message
+static void bench_frame(void (*task_80hz)(void))
+{
+	uint32_t sum = 0, max = 0;
+
+	for (uint8_t n=0; n<BENCH_PASSES; ++n) {
+#ifdef GYRO_FIFO
+		// the FIFO raises the line once, at the watermark
+		bench_gyro_samples(BENCH_GYRO_SAMPLES);
+		bench_pulse(P_GYRODRDY);
+#else
+		for (uint8_t i=0; i<BENCH_GYRO_SAMPLES; ++i)
+			bench_pulse(P_GYRODRDY);
+#endif
+		g_bench_jiffies += 10000 / NOD_BASE_HZ;
+		uint32_t t = bench_cycles();
+		task_80hz();
+		t = bench_since(t);
+		sum += t;
+		if (t > max)
+			max = t;
+	}
+	bench_print(PSTR("frame_80hz"), sum / BENCH_PASSES);
+	bench_print(PSTR("frame_80hz_max"), max);
+}
+
+// the 20 hz pressure branch, conversion start and both collections
+static void bench_baro(void (*task_20hz)(void))
+{
+	uint32_t start = 0, temp = 0, press = 0;
+
+	for (uint8_t n=0; n<BENCH_PASSES; ++n) {
+		uint32_t t = bench_cycles();
+		task_20hz();
+		start += bench_since(t);
+
+		bench_pulse(P_EOC1);
+		bench_pulse(P_EOC2);
+		t = bench_cycles();
+		baro_task();
+		temp += bench_since(t);
+
+		bench_pulse(P_EOC1);
+		bench_pulse(P_EOC2);
+		t = bench_cycles();
+		baro_task();
+		press += bench_since(t);
+	}
+	bench_print(PSTR("baro_start"), start / BENCH_PASSES);
+	bench_print(PSTR("baro_temp"), temp / BENCH_PASSES);
+	bench_print(PSTR("baro_press"), press / BENCH_PASSES);
+	bench_print(PSTR("baro_20hz"), (start + temp + press) / BENCH_PASSES);
+}
+
+// each NOD data function on its own
+static void bench_encoders(void)
+{
+	const char* name = k_nod_names;
+	can_msg_t msg;
+
+	for (uint8_t i=0; i<NOD_NUM_MESSAGES; ++i) {
+		get_nod_msg_data_fn* fn = nod_msg_templates[i].fn;
+		uint32_t t = bench_cycles();
+		for (uint8_t n=0; n<BENCH_PASSES; ++n)
+			fn(&msg);
+		bench_print(name, bench_since(t) / BENCH_PASSES);
+		name += strlen_P(name) + 1;
+	}
+}
+
+// a request for every MIS and MCS entry, request to reply sent
+static void bench_services(void)
+{
+	service_msg_id_t svc = {128, CAN_config.node_id};
+	can_msg_t msg;
+
+	for (uint8_t i=0; i<sizeof(k_mis_codes); ++i) {
+		uint8_t code = pgm_read_byte(&k_mis_codes[i]);
+		memset(&msg, 0, sizeof(msg));
+		msg.id = svc.request_id;
+		msg.data[0] = svc.node_id;
+		msg.data[1] = NODATA;
+		msg.data[2] = 12;
+		msg.data[3] = code;
+		uint32_t t = bench_cycles();
+		nsl_dispatcher_fn_array[12](&CAN_config, &svc, &msg);
+		bench_print_code(PSTR("reply_mis"), code, bench_since(t));
+	}
+
+	for (uint8_t i=0; i<sizeof(k_mcs_codes); ++i) {
+		uint8_t code = pgm_read_byte(&k_mcs_codes[i]);
+		memset(&msg, 0, sizeof(msg));
+		msg.id = svc.request_id;
+		msg.data[0] = svc.node_id;
+		msg.data[1] = pgm_read_byte(&k_mcs_requests[i].type);
+		msg.data[2] = 13;
+		msg.data[3] = code;
+		memcpy_P(&msg.data[4], k_mcs_requests[i].data, 4);
+		uint32_t t = bench_cycles();
+		nsl_dispatcher_fn_array[13](&CAN_config, &svc, &msg);
+		bench_print_code(PSTR("reply_mcs"), code, bench_since(t));
+	}
+}
+
+// a full receive buffer of MIS requests, from the interrupt check to
+// the last reply
+static void bench_poll(void)
+{
+	uint8_t data[8] = {CAN_config.node_id, NODATA, 12, 0, 0, 0, 0, 0};
+
+	for (uint8_t i=0; i<BENCH_RX_FRAMES; ++i)
+		bench_can_receive(128, data);
+	uint32_t t = bench_cycles();
+	if (canaero_handle_interrupt(&CAN_config) == CAN_INTERRUPT)
+		canaero_poll_messages(&CAN_config);
+	bench_print(PSTR("poll_full"), bench_since(t));
+}
+
+// the math kernels, inputs spread over their range
+static void bench_fixmath(void)
+{
+	uint32_t sum[6] = {0, 0, 0, 0, 0, 0};
+
+	for (uint8_t n=0; n<BENCH_PASSES; ++n) {
+		uint32_t v = s_in[n];
+		int16_t s, c;
+		uint32_t t = bench_cycles();
+		s_out = fix_atan2((int32_t)v >> 1, (int32_t)(v >> 3) - 12345);
+		sum[0] += bench_since(t);
+		t = bench_cycles();
+		fix_sincos((uint16_t)v, &s, &c);
+		sum[1] += bench_since(t);
+		s_out = s + c;
+		t = bench_cycles();
+		s_out = fix_isqrt32(v);
+		sum[2] += bench_since(t);
+		t = bench_cycles();
+		s_out = fix_rsqrt32(v);
+		sum[3] += bench_since(t);
+		t = bench_cycles();
+		s_out = fix_log2(v);
+		sum[4] += bench_since(t);
+		t = bench_cycles();
+		s_out = fix_exp2((int32_t)v >> 11);
+		sum[5] += bench_since(t);
+	}
+	bench_print(PSTR("fix_atan2"), sum[0] / BENCH_PASSES);
+	bench_print(PSTR("fix_sincos"), sum[1] / BENCH_PASSES);
+	bench_print(PSTR("fix_isqrt32"), sum[2] / BENCH_PASSES);
+	bench_print(PSTR("fix_rsqrt32"), sum[3] / BENCH_PASSES);
+	bench_print(PSTR("fix_log2"), sum[4] / BENCH_PASSES);
+	bench_print(PSTR("fix_exp2"), sum[5] / BENCH_PASSES);
+}
+
+// the vibration spectrum pieces, a block of a sine and noise, the
+// butterflies as one VIB_SLICE_BUTTERFLIES slice
+static void bench_fft(void)
+{
+	static int16_t x[FFT_SIZE];
+	uint32_t sum[5] = {0, 0, 0, 0, 0};
+
+	for (uint8_t n=0; n<BENCH_PASSES; ++n) {
+		int16_t s, c;
+		for (uint8_t i=0; i<FFT_SIZE; ++i) {
+			fix_sincos((uint16_t)i * (2400 + n * 300), &s, &c);
+			x[i] = (s >> 4) + (int16_t)(s_in[(i + n) & 7] & 63);
+		}
+
+		uint32_t start = bench_cycles();
+		uint32_t t = start;
+		fft_window(x, 0, FFT_SIZE, 32, fft_scale(2100));
+		sum[0] += bench_since(t);
+		t = bench_cycles();
+		fft_bitrev(x);
+		sum[1] += bench_since(t);
+		for (uint8_t b=0; b<FFT_BUTTERFLIES; b+=VIB_SLICE_BUTTERFLIES) {
+			t = bench_cycles();
+			fft_butterflies(x, b, VIB_SLICE_BUTTERFLIES);
+			sum[2] += bench_since(t);
+		}
+		for (uint8_t k=1; k<FFT_BINS; ++k) {
+			t = bench_cycles();
+			s_out = fft_power(x, k);
+			sum[3] += bench_since(t);
+		}
+		sum[4] += bench_since(start);
+	}
+	bench_print(PSTR("fft_window"), sum[0] / BENCH_PASSES);
+	bench_print(PSTR("fft_bitrev"), sum[1] / BENCH_PASSES);
+	bench_print(PSTR("fft_slice"), sum[2] / BENCH_PASSES
+				/ (FFT_BUTTERFLIES / VIB_SLICE_BUTTERFLIES));
+	bench_print(PSTR("fft_power"), sum[3] / BENCH_PASSES / (FFT_BINS - 1));
+	bench_print(PSTR("fft_block"), sum[4] / BENCH_PASSES);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void bench_run(void (*task_80hz)(void), void (*task_20hz)(void))
+{
+	// the sensor interrupt lines are driven from here, held low
+	PORTE &= ~(_BV(P_EOC1) | _BV(P_EOC2) | _BV(P_GYRODRDY));
+	DDRE |= _BV(P_EOC1) | _BV(P_EOC2) | _BV(P_GYRODRDY);
+
+	// timer3 free running at clk / 1
+	TCCR3A = 0;
+	TCCR3B = _BV(CS30);
+	TIMSK3 = _BV(TOIE3);
+	sei();
+
+	uint32_t t = bench_cycles();
+	s_overhead = (uint16_t)(bench_cycles() - t);
+
+	g_state = AHRSACTIVE;
+	g_gyros_enabled = 1;
+	g_accelerometer_enabled = 1;
+	g_static_air_enabled = 1;
+	g_dynamic_air_enabled = 1;
+
+	bench_frame(task_80hz);
+	bench_baro(task_20hz);
+	bench_encoders();
+	bench_services();
+	bench_poll();
+	bench_fixmath();
+	bench_fft();
+
+	puts_P(PSTR("bench done"));
+	_SFR_MEM8(BENCH_EXIT) = 0;
+	for (;;)
+		;
+}
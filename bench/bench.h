@@ -0,0 +1,61 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * cycle counts of the hot paths under simulavr
+ *
+ * the benchmark image is the firmware built with BENCH, USE_GYRO and
+ * USE_ACCEL defined, and the ../libs drivers replaced by stand-ins in
+ * bench/stubs.c, as simulavr has no sensors or CAN controller. With
+ * SENSOR_FIFO, on by default, the stand-ins also answer the FIFO reads
+ * on the i2c bus as the adxl345 and, with GYRO_FIFO, those on the spi
+ * bus as the l3g4200d, hal_avr.h sends the spi transfers to them. After
+ * ioinit() main hands over to bench_run(), which times each path with
+ * timer3 at clk / 1 and prints a line per path
+ *   bench <name> <cycles>
+ * to the simulavr output register, then writes the exit register.
+ * tools/benchcmp.py checks the lines against bench/baseline.txt.
+ *
+ *   make bench             run and compare, fails on a regression or
+ *                          a path without a baseline, lists the
+ *                          counts while none is recorded
+ *   make bench_baseline    run and record the counts as the baseline
+ */
+
+// simulavr special registers, -W BENCH_OUT,<file> -e BENCH_EXIT,
+// PINA and PINC, both unused by the firmware
+#define BENCH_OUT               0x20
+#define BENCH_EXIT              0x26
+
+// frames averaged for each path, a multiple of the pressure divider
+#define BENCH_PASSES            8
+
+// gyro samples captured per 80 hz frame, 400 hz DRDY
+#define BENCH_GYRO_SAMPLES      5
+
+// accel FIFO entries read per 80 hz frame with SENSOR_FIFO, 200 hz
+// rounded up
+#define BENCH_ACCEL_SAMPLES     3
+
+// frames waiting in the stand-in receive buffer for the poll bench
+#define BENCH_RX_FRAMES         8
+
+// the jiffie() the stand-ins return, tenth ms, moved on by the benches
+extern uint32_t g_bench_jiffies;
+
+// samples into the stand-in gyro FIFO, with GYRO_FIFO
+extern void bench_gyro_samples(uint8_t n);
+
+// a frame for the stand-in receive buffer, 0 if it is full
+extern uint8_t bench_can_receive(uint16_t id, const uint8_t* data);
+
+// write one character to BENCH_OUT
+extern void bench_putc(char c);
+
+// run the benchmarks, then stop the simulator, doesn't return
+extern void bench_run(void (*task_80hz)(void), void (*task_20hz)(void));
+
+#endif  // BENCH_H_
@@ -0,0 +1,478 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+
+#include "bench.h"
+#include "defs.h"
+#include "gyro.h"
+#include "uart.h"
+#include "timer.h"
+#include "timer1.h"
+#include "spi.h"
+#include "i2cmaster.h"
+#include "bmp085.h"
+#include "adxl345.h"
+#include "l3g4200d.h"
+#include "canaero.h"
+#include "canaero_filters.h"
+#include "canaero_ids.h"
+#include "canaero_nis.h"
+#include "canaero_bss.h"
+#include "at90can.h"
+#include "watchdog.h"
+#include "conversion.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * stand-ins for the ../libs drivers in the benchmark image
+ *
+ * simulavr has no sensors or CAN controller, these answer at once with
+ * fixed data. The counts are the firmware's own, the time spent in the
+ * real drivers and on the buses isn't part of them.
+ */
+
+#define BMP085_ADDR         0x77
+#define BMP085_CAL          0xaa
+#define BMP085_ADC          0xf6
+
+#define ADXL345_ADDR        0x53
+#define ADXL345_DATAX0      0x32
+#define ADXL345_FIFO_STATUS 0x39
+
+#define L3G_FIFO_SRC_REG    0x2F
+#define L3G_OUT_X_L         0x28
+#define L3G_FIFO_EMPTY      0x20
+#define L3G_FIFO_OVRN       0x40
+#define L3G_FIFO_SIZE       32
+
+uint32_t g_bench_jiffies;
+
+struct can_device at90can_dev;
+
+// datasheet example calibration, then the ADC, UT 27898 and UP 23843
+static const uint8_t k_bmp085_cal[22] = {
+	0x01, 0x98, 0xff, 0xb8, 0xc7, 0xd1, 0x7f, 0xe5, 0x7f, 0xf5, 0x5a, 0x71,
+	0x18, 0x2e, 0x00, 0x04, 0x80, 0x00, 0xdd, 0xf9, 0x0b, 0x34,
+};
+static const uint8_t k_bmp085_ut[2] = {0x6c, 0xfa};
+static const uint8_t k_bmp085_up[3] = {0x5d, 0x23, 0x00};
+
+static const int16_t k_gyro[3] = {12, -7, 3};
+static const int16_t k_accel[3] = {4, -2, -ACCEL_LSB_PER_G};
+
+static uint8_t s_dev;           // i2c address of the transfer
+static uint8_t s_reg;
+static uint8_t s_reg_next;      // next write is the register pointer
+static uint8_t s_convert;       // last bmp085 control write
+static uint8_t s_accel_left;    // adxl345 FIFO entries after this one
+
+#ifdef GYRO_FIFO
+static uint8_t s_gyro_fifo;     // l3g4200d FIFO entries
+static uint8_t s_spi_reg;
+static uint8_t s_spi_byte;      // 0 the address, then the data bytes
+#endif
+
+// the message a CAN send would load into a MOb
+static volatile uint8_t s_mob[8];
+
+// receive buffer
+struct bench_frame {
+	uint16_t id;
+	uint8_t data[8];
+};
+static struct bench_frame s_rx[BENCH_RX_FRAMES];
+static uint8_t s_rx_count;
+
+/*-----------------------------------------------------------------------*/
+
+void bench_putc(char c)
+{
+	_SFR_MEM8(BENCH_OUT) = c;
+}
+
+void uart_init(uint16_t tx_size, uint8_t* tx_buf,
+			   uint16_t rx_size, uint8_t* rx_buf)
+{
+}
+
+int uart_putchar(char c, FILE* stream)
+{
+	bench_putc(c);
+	return 0;
+}
+
+int uart_getchar(FILE* stream)
+{
+	return _FDEV_EOF;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void timer_init(void)
+{
+}
+
+uint32_t jiffie(void)
+{
+	return g_bench_jiffies;
+}
+
+uint32_t timer_elapsed(uint32_t start, uint32_t now)
+{
+	return now - start;
+}
+
+void timer1_init(timer1_init_t* settings)
+{
+}
+
+uint8_t spi_init(uint8_t clock_div)
+{
+	return SPI_OK;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void watchdog_init(uint8_t timeout)
+{
+}
+
+void watchdog_reset(void)
+{
+}
+
+void watchdog_reset_count_update(void)
+{
+}
+
+void watchdog_print_flags(void)
+{
+}
+
+void watchdog_mis2_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(0, &(msg->data[4]));
+	convert_ushort_to_big_endian(0, &(msg->data[6]));
+}
+
+void watchdog_mis3_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(0, &(msg->data[4]));
+	convert_ushort_to_big_endian(0, &(msg->data[6]));
+}
+
+void convert_ushort_to_big_endian(uint16_t v, uint8_t* buf)
+{
+	buf[0] = (uint8_t)(v >> 8);
+	buf[1] = (uint8_t)v;
+}
+
+void convert_float_to_big_endian(float v, uint8_t* buf)
+{
+	uint8_t* p = (uint8_t*)&v;
+	buf[0] = p[3];
+	buf[1] = p[2];
+	buf[2] = p[1];
+	buf[3] = p[0];
+}
+
+/*-----------------------------------------------------------------------*/
+
+// sensors, a fixed sample
+
+void l3g4200d_init(void)
+{
+}
+
+void l3g4200d_self_test(void)
+{
+}
+
+void l3g4200d_read_data(l3g4200d_dev_t* dev)
+{
+}
+
+int16_t l3g4200d_raw_data(l3g4200d_dev_t* dev, uint8_t axis)
+{
+	return k_gyro[axis];
+}
+
+void adxl345_init(struct adxl345_device* dev)
+{
+}
+
+uint8_t adxl345_self_test(void)
+{
+	return 0;
+}
+
+void adxl345_internal_self_test(void)
+{
+}
+
+void adxl345_read_accel(void)
+{
+}
+
+int16_t adxl345_accel(uint8_t axis)
+{
+	return k_accel[axis];
+}
+
+uint8_t bmp085_init(uint8_t mode, struct bmp085_dev_t* dev)
+{
+	return BMP085_OK;
+}
+
+uint8_t bmp085_self_test(struct bmp085_dev_t* dev)
+{
+	return BMP085_OK;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// i2c, a bmp085 that converts instantly, and the FIFO of an adxl345
+// that has BENCH_ACCEL_SAMPLES in it whenever a frame starts reading
+
+void i2c_init(void)
+{
+}
+
+unsigned char i2c_start(unsigned char addr)
+{
+	s_dev = addr >> 1;
+	s_reg_next = !(addr & I2C_READ);
+	return s_dev != BMP085_ADDR && s_dev != ADXL345_ADDR;
+}
+
+unsigned char i2c_rep_start(unsigned char addr)
+{
+	return i2c_start(addr);
+}
+
+void i2c_start_wait(unsigned char addr)
+{
+	i2c_start(addr);
+}
+
+void i2c_stop(void)
+{
+}
+
+unsigned char i2c_write(unsigned char data)
+{
+	if (s_reg_next) {
+		s_reg = data;
+		s_reg_next = 0;
+	} else if (s_dev == BMP085_ADDR) {
+		s_convert = data;
+	}
+	return 0;
+}
+
+// the read of DATAX0 takes an entry off, FIFO_STATUS says what is left
+static uint8_t adxl345_read(uint8_t reg)
+{
+	if (reg == ADXL345_DATAX0) {
+		if (s_accel_left == 0)
+			s_accel_left = BENCH_ACCEL_SAMPLES;
+		--s_accel_left;
+	}
+	if (reg >= ADXL345_DATAX0 && reg < ADXL345_DATAX0 + 6) {
+		uint16_t v = (uint16_t)k_accel[(reg - ADXL345_DATAX0) >> 1];
+		return (reg & 1) ? (uint8_t)(v >> 8) : (uint8_t)v;
+	}
+	if (reg == ADXL345_FIFO_STATUS)
+		return s_accel_left;
+	return 0;
+}
+
+unsigned char i2c_readAck(void)
+{
+	uint8_t reg = s_reg++;
+	if (s_dev == ADXL345_ADDR)
+		return adxl345_read(reg);
+	if (reg >= BMP085_CAL && reg < BMP085_CAL + sizeof(k_bmp085_cal))
+		return k_bmp085_cal[reg - BMP085_CAL];
+	if (reg >= BMP085_ADC && reg < BMP085_ADC + 3) {
+		// temperature command 0x2e, else a pressure
+		if (s_convert == 0x2e)
+			return (reg < BMP085_ADC + 2) ? k_bmp085_ut[reg - BMP085_ADC] : 0;
+		return k_bmp085_up[reg - BMP085_ADC];
+	}
+	return 0;
+}
+
+unsigned char i2c_readNak(void)
+{
+	return i2c_readAck();
+}
+
+/*-----------------------------------------------------------------------*/
+
+// spi, the FIFO of an l3g4200d that bench_gyro_samples() fills, only
+// with GYRO_FIFO, the driver stand-ins above answer otherwise
+
+#ifdef GYRO_FIFO
+
+void bench_gyro_samples(uint8_t n)
+{
+	s_gyro_fifo += n;
+}
+
+void bench_spi_select(void)
+{
+	s_spi_byte = 0;
+}
+
+uint8_t bench_spi_transfer(uint8_t b)
+{
+	if (s_spi_byte++ == 0) {
+		// read and auto increment bits off, they're the only ones used
+		s_spi_reg = b & 0x3f;
+		return 0;
+	}
+	if (s_spi_reg == L3G_FIFO_SRC_REG) {
+		if (s_gyro_fifo == 0)
+			return L3G_FIFO_EMPTY;
+		if (s_gyro_fifo > L3G_FIFO_SIZE) {
+			s_gyro_fifo = L3G_FIFO_SIZE;
+			return L3G_FIFO_OVRN;
+		}
+		return s_gyro_fifo & (L3G_FIFO_SIZE - 1);
+	}
+	if (s_spi_reg != L3G_OUT_X_L)
+		return 0;
+	// a burst, x, y, z little endian per FIFO entry
+	uint8_t i = (s_spi_byte - 2) % 6;
+	uint16_t v = (uint16_t)k_gyro[i >> 1];
+	if (i == 5 && s_gyro_fifo)
+		--s_gyro_fifo;
+	return (i & 1) ? (uint8_t)(v >> 8) : (uint8_t)v;
+}
+
+#endif  // GYRO_FIFO
+
+/*-----------------------------------------------------------------------*/
+
+// CAN, sends are copied out as into a MOb, receives come from
+// bench_can_receive()
+
+static void bench_can_send(canaero_init_t* cfg, uint16_t id, uint8_t type,
+						   uint8_t svc, uint8_t code,
+						   get_nod_msg_data_fn* fn)
+{
+	can_msg_t msg;
+	msg.id = id;
+	msg.data[0] = cfg->node_id;
+	msg.data[1] = type;
+	msg.data[2] = svc;
+	msg.data[3] = code;
+	if (fn)
+		fn(&msg);
+	for (uint8_t i=0; i<8; ++i)
+		s_mob[i] = msg.data[i];
+}
+
+int canaero_init(canaero_init_t* cfg, struct can_device* dev)
+{
+	cfg->can_dev = dev;
+	return CAN_OK;
+}
+
+int canaero_self_test(canaero_init_t* cfg)
+{
+	return CAN_OK;
+}
+
+void canaero_high_priority_service_filters(canaero_init_t* cfg)
+{
+	cfg->can_settings.filters.filtering_on = 1;
+}
+
+void canaero_no_filters(canaero_init_t* cfg)
+{
+	cfg->can_settings.filters.filtering_on = 0;
+}
+
+void canaero_reset_nod_message_sequence(canaero_init_t* cfg)
+{
+}
+
+void can_clear_tx_buffers(struct can_device* dev)
+{
+}
+
+int canaero_send_messages(canaero_init_t* cfg, int first, int end)
+{
+	for (int i=first; i<end; ++i) {
+		canaero_msg_tmpl_t* t = &cfg->nod_msg_templates[i];
+		bench_can_send(cfg, t->message_id, t->data_type, t->service_code,
+					   t->message_code, t->fn);
+	}
+	return CAN_OK;
+}
+
+int canaero_send_svc_reply_message(canaero_init_t* cfg, service_msg_id_t* svc,
+								   canaero_svc_msg_tmpl_t* tmpl)
+{
+	bench_can_send(cfg, svc->request_id + 1, tmpl->data_type,
+				   tmpl->service_code, tmpl->message_code, tmpl->fn);
+	return CAN_OK;
+}
+
+uint8_t bench_can_receive(uint16_t id, const uint8_t* data)
+{
+	if (s_rx_count == BENCH_RX_FRAMES)
+		return 0;
+	s_rx[s_rx_count].id = id;
+	memcpy(s_rx[s_rx_count].data, data, 8);
+	++s_rx_count;
+	return 1;
+}
+
+int canaero_handle_interrupt(canaero_init_t* cfg)
+{
+	return s_rx_count ? CAN_INTERRUPT : CAN_NOINTERRUPT;
+}
+
+void canaero_poll_messages(canaero_init_t* cfg)
+{
+	can_msg_t msg;
+
+	for (uint8_t i=0; i<s_rx_count; ++i) {
+		msg.id = s_rx[i].id;
+		msg.length = 8;
+		memcpy(msg.data, s_rx[i].data, 8);
+		if (msg.data[0] != 0 && msg.data[0] != cfg->node_id)
+			continue;
+		reply_svc_fn* fn = cfg->nsl_dispatcher_fn_array[msg.data[2] & 15];
+		if (fn) {
+			service_msg_id_t svc = {msg.id, msg.data[0]};
+			fn(cfg, &svc, &msg);
+		}
+	}
+	s_rx_count = 0;
+}
+
+int canaero_reply_ids(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {UCHAR4, 0, msg->data[3], 0};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
+
+int canaero_reply_nis(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {NODATA, 11, msg->data[3], 0};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
+
+int canaero_reply_bss(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {NODATA, 10, msg->data[3], 0};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
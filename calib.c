@@ -0,0 +1,123 @@
+#include <inttypes.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "calib.h"
+
+/*-----------------------------------------------------------------------*/
+
+static struct calib_coef s_gyro_coef;
+static struct calib_coef s_accel_coef;
+static uint8_t s_valid;
+
+// bias at the last temperature
+static int16_t s_gyro_bias[3];
+static int16_t s_accel_bias[3];
+static int16_t s_temp;
+static uint8_t s_have_temp;
+
+// corrected samples
+static int16_t s_gyro[3];
+static int16_t s_accel[3];
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t calib_init(void)
+{
+	struct calib_eeprom e;
+
+	eeprom_read_block(&e, (const void*)EEPROM_CALIB_ADDR, sizeof(e));
+
+	uint16_t crc = 0xffff;
+	const uint8_t* p = (const uint8_t*)&e;
+	for (uint8_t i=0; i<sizeof(e) - sizeof(e.crc); ++i)
+		crc = _crc16_update(crc, p[i]);
+
+	s_have_temp = 0;
+	s_valid = e.magic == EEPROM_CALIB_MAGIC && e.version == CALIB_VERSION
+		&& e.crc == crc;
+	if (!s_valid)
+		return 1;
+	s_gyro_coef = e.gyro;
+	s_accel_coef = e.accel;
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static int16_t saturate(int32_t v)
+{
+	if (v > INT16_MAX)
+		return INT16_MAX;
+	if (v < INT16_MIN)
+		return INT16_MIN;
+	return (int16_t)v;
+}
+
+// bias polynomial of each axis at temperature offset dt
+static void calib_bias(const struct calib_coef* c, int16_t dt, int16_t bias[3])
+{
+	int32_t dt2 = ((int32_t)dt * dt) >> 8;
+
+	for (uint8_t i=0; i<3; ++i) {
+		int32_t b = c->bias[i][0];
+		b += ((int32_t)c->bias[i][1] * dt + 128) >> 8;
+		b += ((int32_t)c->bias[i][2] * dt2 + 128) >> 8;
+		bias[i] = saturate(b);
+	}
+}
+
+// out = M * (raw - bias), each product is pre-shifted so the sum of
+// three can't overflow
+static void calib_apply(const struct calib_coef* c, const int16_t bias[3],
+						const int16_t raw[3], int16_t out[3])
+{
+	int16_t v[3];
+
+	for (uint8_t i=0; i<3; ++i)
+		v[i] = saturate((int32_t)raw[i] - bias[i]);
+	for (uint8_t i=0; i<3; ++i) {
+		int32_t sum = 0;
+		for (uint8_t j=0; j<3; ++j)
+			sum += ((int32_t)c->matrix[i][j] * v[j]) >> 2;
+		out[i] = saturate((sum + 2048) >> 12);
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void calib_update(const int16_t gyro[3], const int16_t accel[3], int16_t temp)
+{
+	if (!s_valid) {
+		for (uint8_t i=0; i<3; ++i) {
+			s_gyro[i] = gyro[i];
+			s_accel[i] = accel[i];
+		}
+		return;
+	}
+
+	// the temperature only changes at the pressure sensor rate
+	if (!s_have_temp || temp != s_temp) {
+		int16_t dt = temp - CALIB_TREF;
+		calib_bias(&s_gyro_coef, dt, s_gyro_bias);
+		calib_bias(&s_accel_coef, dt, s_accel_bias);
+		s_temp = temp;
+		s_have_temp = 1;
+	}
+	calib_apply(&s_gyro_coef, s_gyro_bias, gyro, s_gyro);
+	calib_apply(&s_accel_coef, s_accel_bias, accel, s_accel);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t calib_gyro(uint8_t axis)
+{
+	return s_gyro[axis];
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t calib_accel(uint8_t axis)
+{
+	return s_accel[axis];
+}
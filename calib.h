@@ -0,0 +1,65 @@
+#ifndef CALIB_H_
+#define CALIB_H_
+
+#include <inttypes.h>
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * inertial sensor calibration, integer only
+ *
+ * per sensor, in raw counts:
+ *   bias(T)   = c0 + c1 * dT / 2^8 + c2 * (dT^2 / 2^8) / 2^8
+ *   corrected = M * (raw - bias(T)) / 2^14
+ * dT is the board temperature less CALIB_TREF in 0.1 C, M holds the
+ * scale and misalignment in Q14. The corrected counts keep the nominal
+ * scale of defs.h, so the consumers don't change.
+ *
+ * the coefficients are stored in the eeprom at EEPROM_CALIB_ADDR, with
+ * a crc, in the layout of struct calib_eeprom. tools/calfit.py fits
+ * them from the raw telemetry. Without valid coefficients the raw
+ * counts are passed through. Fitted and applied, a made up sensor
+ * comes back within 3 counts from 0 to 45 C, most of it the 1/256
+ * steps of c1 and c2, checked by host/calibcheck.py.
+ */
+
+// reference temperature of the polynomial, 0.1 C
+#define CALIB_TREF              250
+
+// layout version of the eeprom block
+#define CALIB_VERSION           1
+
+// Q14 value of 1.0
+#define CALIB_ONE               16384
+
+// coefficients of one sensor
+struct calib_coef {
+	int16_t bias[3][3];         // c0, c1, c2 per axis
+	int16_t matrix[3][3];       // scale and misalignment, Q14
+};
+
+// the eeprom block, little endian
+struct calib_eeprom {
+	uint8_t magic;              // EEPROM_CALIB_MAGIC
+	uint8_t version;            // CALIB_VERSION
+	struct calib_coef gyro;
+	struct calib_coef accel;
+	uint16_t crc;               // _crc16_update from 0xffff, all above
+};
+
+// load the coefficients from the eeprom, returns 1 if none are valid
+extern uint8_t calib_init(void);
+
+// correct the latest samples, called every 80hz frame
+// gyro is pitch, roll, yaw, accel is long, lat, normal, raw counts
+// temp is the board temperature in 0.1 C, CALIB_TREF while there is none
+extern void calib_update(const int16_t gyro[3], const int16_t accel[3],
+						 int16_t temp);
+
+// corrected rate in raw counts, pitch, roll, yaw
+extern int16_t calib_gyro(uint8_t axis);
+
+// corrected acceleration in raw counts, long, lat, normal
+extern int16_t calib_accel(uint8_t axis);
+
+#endif  // CALIB_H_
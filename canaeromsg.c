@@ -1,59 +1,161 @@
 #include <stdio.h>
+#include <string.h>
 #include <avr/pgmspace.h>
 #include "defs.h"
 #include "globals.h"
 #include "adxl345.h"
-#include "l3g4200d.h"
+#include "attitude.h"
+#include "airdata.h"
+#include "vib.h"
+#include "filter.h"
 #include "canaeromsg.h"
 #include "canaero_nis.h"
 #include "canaero_ids.h"
 #include "canaero_bss.h"
 #include "canaero_filters.h"
 #include "watchdog.h"
+#include "prof.h"
+#include "jitter.h"
+#include "stackmon.h"
+#include "trace.h"
+#include "telem.h"
+#include "config.h"
 #include "conversion.h"
+#include "timer.h"
 
 /*-----------------------------------------------------------------------*/
 
 // message data functions
 
+// by default the payload is the raw count from the driver, the scale
+// is fixed at compile time (see defs.h, MIS code 11), no floating
+// point is needed. FLOAT_NOD_DATA sends the standard FLOAT payload.
+#ifdef FLOAT_NOD_DATA
+#define NOD_SHORT_TYPE		FLOAT
+#define NOD_LONG_TYPE		FLOAT
+#define NOD_ANGLE_TYPE		FLOAT
+#define NOD_HEADING_TYPE	FLOAT
+#define nod_angle(axis)		attitude_degrees(axis)
+#define nod_metres(cm)		((cm) * 0.01f)
+#define nod_hertz(chz)		((chz) * 0.01f)
+#define nod_g(mg)			((mg) * 0.001f)
+#define put_short(v, buf)	convert_float_to_big_endian((v), (buf))
+#define put_ushort(v, buf)	convert_float_to_big_endian((v), (buf))
+#define put_long(v, buf)	convert_float_to_big_endian((v), (buf))
+#else
+#define NOD_SHORT_TYPE		SHORT
+#define NOD_LONG_TYPE		LONG
+#define NOD_ANGLE_TYPE		SHORT
+#define NOD_HEADING_TYPE	USHORT
+#define nod_angle(axis)		attitude_angle(axis)
+#define nod_metres(cm)		(cm)
+#define nod_hertz(chz)		(chz)
+#define nod_g(mg)			(mg)
+#define put_ushort(v, buf)	convert_ushort_to_big_endian((v), (buf))
+
+static void put_short(int16_t v, uint8_t* buf)
+{
+	buf[0] = (uint8_t)(v >> 8);
+	buf[1] = (uint8_t)v;
+}
+
+static void put_long(int32_t v, uint8_t* buf)
+{
+	buf[0] = (uint8_t)(v >> 24);
+	buf[1] = (uint8_t)(v >> 16);
+	buf[2] = (uint8_t)(v >> 8);
+	buf[3] = (uint8_t)v;
+}
+#endif
+
 static void get_body_long_accel(can_msg_t *msg)
 {
-	convert_float_to_big_endian(adxl345_accel(0), &(msg->data[4]));
+	put_short(filter_output(FILTER_LONG_ACCEL), &(msg->data[4]));
 }
 
 static void get_body_lat_accel(can_msg_t *msg)
 {
-	convert_float_to_big_endian(adxl345_accel(1), &(msg->data[4]));
+	put_short(filter_output(FILTER_LAT_ACCEL), &(msg->data[4]));
 }
 
 static void get_body_norm_accel(can_msg_t *msg)
 {
-	convert_float_to_big_endian(adxl345_accel(2), &(msg->data[4]));
+	put_short(filter_output(FILTER_NORM_ACCEL), &(msg->data[4]));
 }
 
 static void get_body_pitch_rate(can_msg_t *msg)
 {
-	convert_float_to_big_endian(l3g4200d_raw_data(&g_gyro_dev, 0), &(msg->data[4]));
+	put_short(filter_output(FILTER_PITCH_RATE), &(msg->data[4]));
 }
 
 static void get_body_roll_rate(can_msg_t *msg)
 {
-	convert_float_to_big_endian(l3g4200d_raw_data(&g_gyro_dev, 1), &(msg->data[4]));
+	put_short(filter_output(FILTER_ROLL_RATE), &(msg->data[4]));
 }
 
 static void get_body_yaw_rate(can_msg_t *msg)
 {
-	convert_float_to_big_endian(l3g4200d_raw_data(&g_gyro_dev, 2), &(msg->data[4]));
+	put_short(filter_output(FILTER_YAW_RATE), &(msg->data[4]));
 }
 
 static void get_static_pressure(can_msg_t *msg)
 {
-	convert_float_to_big_endian(g_bmp085_data[0].press, &(msg->data[4]));
+	put_long(filter_output(FILTER_STATIC_PRESS), &(msg->data[4]));
 }
 
 static void get_total_pressure(can_msg_t *msg)
 {
-	convert_float_to_big_endian(g_bmp085_data[1].press, &(msg->data[4]));
+	put_long(filter_output(FILTER_TOTAL_PRESS), &(msg->data[4]));
+}
+
+static void get_body_pitch_angle(can_msg_t *msg)
+{
+	put_short(nod_angle(ATT_PITCH), &(msg->data[4]));
+}
+
+static void get_body_roll_angle(can_msg_t *msg)
+{
+	put_short(nod_angle(ATT_ROLL), &(msg->data[4]));
+}
+
+static void get_heading_angle(can_msg_t *msg)
+{
+	put_ushort(nod_angle(ATT_HEADING), &(msg->data[4]));
+}
+
+static void get_altitude_rate(can_msg_t *msg)
+{
+	put_short(nod_metres(airdata_vertical_speed()), &(msg->data[4]));
+}
+
+static void get_indicated_airspeed(can_msg_t *msg)
+{
+	put_short(nod_metres(airdata_airspeed()), &(msg->data[4]));
+}
+
+static void get_baro_altitude(can_msg_t *msg)
+{
+	put_long(nod_metres(airdata_baro_altitude()), &(msg->data[4]));
+}
+
+static void get_standard_altitude(can_msg_t *msg)
+{
+	put_long(nod_metres(airdata_altitude()), &(msg->data[4]));
+}
+
+static void get_vibration_frequency(can_msg_t *msg)
+{
+	put_short(nod_hertz(vib_frequency()), &(msg->data[4]));
+}
+
+static void get_vibration_amplitude(can_msg_t *msg)
+{
+	put_short(nod_g(vib_amplitude()), &(msg->data[4]));
+}
+
+static void get_vibration_rms(can_msg_t *msg)
+{
+	put_short(nod_g(vib_rms()), &(msg->data[4]));
 }
 
 static void get_cycle_time(can_msg_t *msg)
@@ -61,35 +163,130 @@ static void get_cycle_time(can_msg_t *msg)
 	convert_ushort_to_big_endian(g_cycle_time, &(msg->data[4]));
 }
 
+// scale down and saturate to a signed field of 'bits'
+static uint32_t pack_field(int16_t v, uint8_t shift, uint8_t bits)
+{
+	int16_t max = (1 << (bits - 1)) - 1;
+	v >>= shift;
+	if (v > max)
+		v = max;
+	else if (v < -max - 1)
+		v = -max - 1;
+	return (uint16_t)v & ((1U << bits) - 1);
+}
+
+// three axes as 11/11/10 bits, msb first
+static void put_vector(int16_t x, int16_t y, int16_t z, uint8_t shift,
+					   uint8_t* buf)
+{
+	uint32_t v = (pack_field(x, shift, 11) << 21)
+		| (pack_field(y, shift, 11) << 10)
+		| pack_field(z, shift, 10);
+	buf[0] = (uint8_t)(v >> 24);
+	buf[1] = (uint8_t)(v >> 16);
+	buf[2] = (uint8_t)(v >> 8);
+	buf[3] = (uint8_t)v;
+}
+
+static void get_body_accel_vector(can_msg_t *msg)
+{
+	put_vector(filter_output(FILTER_LONG_ACCEL),
+			   filter_output(FILTER_LAT_ACCEL),
+			   filter_output(FILTER_NORM_ACCEL),
+			   COMPACT_ACCEL_SHIFT, &(msg->data[4]));
+}
+
+static void get_body_rate_vector(can_msg_t *msg)
+{
+	put_vector(filter_output(FILTER_PITCH_RATE),
+			   filter_output(FILTER_ROLL_RATE),
+			   filter_output(FILTER_YAW_RATE),
+			   COMPACT_GYRO_SHIFT, &(msg->data[4]));
+}
+
 /*-----------------------------------------------------------------------*/
 
-// messages defined for this unit
+// messages defined for this unit, see canaerospec.h
+#define NOD_TEMPLATE(a, name, id, type, fn, value, range, div) \
+	[name] = {NOD, id, 0, type, 0, 0, fn},
 canaero_msg_tmpl_t nod_msg_templates[] = {
-	/* the following are raw data messages for calibration,etc */
-	/* ------------------------------------------------------- */
-	/* cycle time */
-	{NOD, 0x100, 0, USHORT, 0, 0, get_cycle_time},
-	/* Body Longitudinal Acceleration */
-	{NOD, 0x101, 0, FLOAT, 0, 0, get_body_long_accel},
-	/* Body Lateral Acceleration */
-	{NOD, 0x102, 0, FLOAT, 0, 0, get_body_lat_accel},
-	/* Body Normal Acceleration */
-	{NOD, 0x103, 0, FLOAT, 0, 0, get_body_norm_accel},
-	/* Body pitch rate */
-	{NOD, 0x104, 0, FLOAT, 0, 0, get_body_pitch_rate},
-	/* Body roll rate */
-	{NOD, 0x105, 0, FLOAT, 0, 0, get_body_roll_rate},
-	/* Body yaw rate */
-	{NOD, 0x106, 0, FLOAT, 0, 0, get_body_yaw_rate},
-	/* Static pressure */
-	{NOD, 0x108, 0, FLOAT, 0, 0, get_static_pressure},
-	/* Total pressure */
-	{NOD, 0x10A, 0, FLOAT, 0, 0, get_total_pressure},
+	NOD_MESSAGES(NOD_TEMPLATE, 0)
 };
 
 int num_nod_templates = sizeof(nod_msg_templates)
 	/ sizeof(canaero_msg_tmpl_t);
 
+// each message lies inside its send range, so the ranges are adjacent
+// and in order
+#define NOD_CHECK(a, name, id, type, fn, value, range, div) \
+	STATIC_ASSERT(name, (int)name >= NOD_##range##_FIRST \
+				  && (int)name < NOD_##range##_END);
+NOD_MESSAGES(NOD_CHECK, 0)
+
+// the packed vectors come last
+STATIC_ASSERT(nod_deadband_end,
+			  NOD_COMPACT_GYRO_END == (int)NOD_NUM_MESSAGES
+			  && NOD_COMPACT_ACCEL_END == NOD_COMPACT_GYRO_FIRST);
+
+/*-----------------------------------------------------------------------*/
+
+// change driven transmission, the deadband, refresh time and divider
+// of each message are in g_config
+struct nod_filter {
+	int32_t last;           // raw value when last sent
+	uint16_t sent;          // ms time stamp of the last send
+	uint8_t count;          // base frames since the last send
+};
+
+static struct nod_filter s_filter[NOD_NUM_MESSAGES];
+
+// message last configured over MCS, for the reply
+static uint8_t s_filter_msg;
+
+// raw value a deadband is applied to, packed vectors have none
+#define NOD_VALUE(a, name, id, type, fn, value, range, div) \
+	case name: return value;
+static int32_t nod_value(uint8_t msg)
+{
+	switch (msg) {
+	NOD_MESSAGES(NOD_VALUE, 0)
+	default:
+		return 0;
+	}
+}
+
+void nod_init(void)
+{
+	for (uint8_t i=0; i<NOD_NUM_MESSAGES; ++i)
+		s_filter[i].count = 0;
+}
+
+void nod_send_messages(uint8_t first, uint8_t end)
+{
+	uint16_t now = jiffie() / 10;
+
+	for (uint8_t i=first; i<end; ++i) {
+		struct nod_filter* f = &s_filter[i];
+		uint8_t divider = g_config.nod_divider[i];
+		if (divider == 0 || ++f->count < divider)
+			continue;
+		f->count = 0;
+		uint16_t deadband = g_config.nod_deadband[i];
+		if (deadband) {
+			int32_t v = nod_value(i);
+			int32_t d = (v > f->last) ? v - f->last : f->last - v;
+			uint16_t refresh = g_config.nod_refresh[i];
+			if (refresh == 0)
+				refresh = NOD_REFRESH_MS;
+			if (d < deadband && (uint16_t)(now - f->sent) < refresh)
+				continue;
+			f->last = v;
+			f->sent = now;
+		}
+		canaero_send_messages(&CAN_config, i, i + 1);
+	}
+}
+
 /*-----------------------------------------------------------------------*/
 
 // service message data functions
@@ -118,174 +315,330 @@ static void get_mis10_data(can_msg_t* msg)
 	msg->data[7] = g_dynamic_air_enabled;
 }
 
+static void get_mis11_data(can_msg_t* msg)
+{
+	// scale of the raw count payloads
+	convert_ushort_to_big_endian(GYRO_UDPS_PER_LSB, &(msg->data[4]));
+	convert_ushort_to_big_endian(ACCEL_LSB_PER_G, &(msg->data[6]));
+}
+
 /*-----------------------------------------------------------------------*/
 
+static void get_mis12_data(can_msg_t* msg)
+{
+	msg->data[4] = g_config.compact_nod;
+}
+
+static void get_mcs13_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_filter_msg, &(msg->data[4]));
+	convert_ushort_to_big_endian(g_config.nod_deadband[s_filter_msg],
+								 &(msg->data[6]));
+}
+
+static void get_mcs15_data(can_msg_t* msg)
+{
+	msg->data[4] = s_filter_msg;
+	msg->data[5] = g_config.nod_divider[s_filter_msg];
+}
+
+static void get_mcs14_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_filter_msg, &(msg->data[4]));
+	convert_ushort_to_big_endian(g_config.nod_refresh[s_filter_msg],
+								 &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+// the service reply templates are kept in flash, copy one to the
+// stack for the send
+static int reply_svc_P(canaero_init_t* proto, service_msg_id_t* svc,
+					   const canaero_svc_msg_tmpl_t* tmpl)
+{
+	canaero_svc_msg_tmpl_t t;
+	memcpy_P(&t, tmpl, sizeof(t));
+	return canaero_send_svc_reply_message(proto, svc, &t);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// MIS and MCS dispatch, both are tables in flash indexed by the
+// message code, built from canaerospec.h. Every request costs one
+// bounds check and one table read, whatever the code.
+
+// a code listed twice would silently replace the first entry
+#pragma GCC diagnostic error "-Woverride-init"
+
+// expand E once per code of a block, c is the code, b the block base
+#define SVC_REP1(E, c, b, ...)  E(c, b, __VA_ARGS__)
+#define SVC_REP2(E, c, b, ...)  SVC_REP1(E, c, b, __VA_ARGS__) \
+	SVC_REP1(E, (c) + 1, b, __VA_ARGS__)
+#define SVC_REP4(E, c, b, ...)  SVC_REP2(E, c, b, __VA_ARGS__) \
+	SVC_REP2(E, (c) + 2, b, __VA_ARGS__)
+#define SVC_REP8(E, c, b, ...)  SVC_REP4(E, c, b, __VA_ARGS__) \
+	SVC_REP4(E, (c) + 4, b, __VA_ARGS__)
+#define SVC_REP10(E, c, b, ...) SVC_REP8(E, c, b, __VA_ARGS__) \
+	SVC_REP2(E, (c) + 8, b, __VA_ARGS__)
+#define SVC_REP11(E, c, b, ...) SVC_REP10(E, c, b, __VA_ARGS__) \
+	SVC_REP1(E, (c) + 10, b, __VA_ARGS__)
+#define SVC_REP16(E, c, b, ...) SVC_REP8(E, c, b, __VA_ARGS__) \
+	SVC_REP8(E, (c) + 8, b, __VA_ARGS__)
+
+/*-----------------------------------------------------------------------*/
+
+// MIS code, no data function means we don't answer it
+struct mis_entry {
+	canaero_data_type_t type;
+	get_nod_msg_data_fn* fn;
+	void (*select)(uint8_t offset);
+	uint8_t base;
+};
+
+#define MIS_ENTRY(c, b, type, fn, select) [c] = {type, fn, select, b},
+#define MIS_TABLE(code, rep, count, type, fn, select) \
+	SVC_REP##rep(MIS_ENTRY, code, code, type, fn, select)
+static const struct mis_entry k_mis[] PROGMEM = {
+	MIS_SERVICES(MIS_TABLE)
+};
+
+#define MIS_CHECK(code, rep, count, type, fn, select) \
+	STATIC_ASSERT(mis_##code, (rep) == (count));
+MIS_SERVICES(MIS_CHECK)
+
 // MIS service reply
 // get module configuration
 int reply_mis(canaero_init_t* proto, service_msg_id_t* svc, can_msg_t* msg)
 {
-	/* Module Information Service Request code 0 */
-	static canaero_svc_msg_tmpl_t t0 = {UCHAR2, 12, 0, get_mis0_data};
-	
-	/* Module Information Service Request code 1 */
-	static canaero_svc_msg_tmpl_t t1 = {UCHAR4, 12, 1, get_mis1_data};
-	
-	/* Module Information Service Request code 2 */
-	static canaero_svc_msg_tmpl_t t2 = {USHORT2, 12, 2, watchdog_mis2_data};
-	
-	/* Module Information Service Request code 3 */
-	static canaero_svc_msg_tmpl_t t3 = {USHORT2, 12, 3, watchdog_mis3_data};
-	
-	/* Module Information Service Request code 10 */
-	static canaero_svc_msg_tmpl_t t10 = {UCHAR4, 12, 10, get_mis10_data};
-	
 	/* Module Information Service Request invalid code */
-	static canaero_svc_msg_tmpl_t invalid = {NODATA, 12, 255, 0};
+	static const canaero_svc_msg_tmpl_t invalid PROGMEM = {NODATA, 12, 255, 0};
 
-	// ensure the data format is as we expect
-	if (msg->data[1] != NODATA)
-		return canaero_send_svc_reply_message(proto, svc, &invalid);
-		
+	uint8_t code = msg->data[3];
 	uint8_t snd_stat;
+	struct mis_entry e;
 
-	// the message code gives the type of module configuration requested
-	switch (msg->data[3]) {
-	case 0:
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t0);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code 0"));
-#endif
-		break;
-	case 1:
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t1);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code 1"));
-#endif
-		break;
-	case 2:
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t2);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code 2"));
-#endif
-		break;
-	case 3:
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t3);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code 3"));
-#endif
-		break;
-	case 10:
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t10);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code 10"));
-#endif
-		break;
-	default:
-		// we don't respond to these message codes
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &invalid);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MIS code unknown"));
-#endif
+	if (code < sizeof(k_mis) / sizeof(k_mis[0]))
+		memcpy_P(&e, &k_mis[code], sizeof(e));
+	else
+		e.fn = 0;
+
+	// ensure the data format is as we expect, and that we answer the code
+	if (msg->data[1] != NODATA || e.fn == 0) {
+		snd_stat = reply_svc_P(proto, svc, &invalid);
+	} else {
+		canaero_svc_msg_tmpl_t t = {e.type, 12, code, e.fn};
+		if (e.select)
+			e.select(code - e.base);
+		snd_stat = canaero_send_svc_reply_message(proto, svc, &t);
 	}
-	
+
+	trace(TRACE_MIS_REPLY, code, snd_stat, 0);
 	return snd_stat;
 }
 
 /*-----------------------------------------------------------------------*/
 
+// result of a set function
+enum mcs_result {
+	MCS_DONE,           // reply
+	MCS_INVALID,        // reply invalid code
+	MCS_REINIT,         // reply, then restart the canaero stack
+};
+
+// apply an MCS request, the payload type has been checked
+typedef enum mcs_result (mcs_set_fn)(can_msg_t* msg);
+
+static enum mcs_result mcs_state(can_msg_t* msg)
+{
+	// set listen/active state
+	if (msg->data[4])
+		g_state = AHRSLISTEN;
+	else
+		g_state = AHRSACTIVE;
+	g_config.active = !msg->data[4];
+	g_config.filtering = msg->data[5] ? 1 : 0;
+	config_changed();
+
+	// second byte is filtering on/off
+	if (CAN_config.can_settings.filters.filtering_on == msg->data[5])
+		return MCS_DONE;
+
+	// setup the filters as setting is changed
+	if (msg->data[5])
+		canaero_high_priority_service_filters(&CAN_config);
+	else
+		canaero_no_filters(&CAN_config);
+	return MCS_REINIT;
+}
+
+static enum mcs_result mcs_counters(can_msg_t* msg)
+{
+	// reset the message counters, and clear tx buffers, if requested
+	if (msg->data[5])
+		can_clear_tx_buffers(CAN_config.can_dev);
+	if (msg->data[4])
+		canaero_reset_nod_message_sequence(&CAN_config);
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_sensors(can_msg_t* msg)
+{
+	// read and set the configuration variables
+	g_accelerometer_enabled = msg->data[4];
+	g_gyros_enabled = msg->data[5];
+	g_static_air_enabled = msg->data[6];
+	g_dynamic_air_enabled = msg->data[7];
+	g_config.accel_enabled = msg->data[4];
+	g_config.gyros_enabled = msg->data[5];
+	g_config.static_air_enabled = msg->data[6];
+	g_config.dynamic_air_enabled = msg->data[7];
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_compact(can_msg_t* msg)
+{
+	// standard or compact accel and rate messages
+	g_config.compact_nod = msg->data[4] ? 1 : 0;
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_deadband(can_msg_t* msg)
+{
+	// packed vectors don't have a deadband
+	if (msg->data[4] != 0 || msg->data[5] >= NOD_DEADBAND_END)
+		return MCS_INVALID;
+
+	// message index and deadband in raw counts
+	s_filter_msg = msg->data[5];
+	g_config.nod_deadband[s_filter_msg] = ((uint16_t)msg->data[6] << 8)
+		| msg->data[7];
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_refresh(can_msg_t* msg)
+{
+	if (msg->data[4] != 0 || msg->data[5] >= NOD_DEADBAND_END)
+		return MCS_INVALID;
+
+	// message index and longest silence in ms
+	s_filter_msg = msg->data[5];
+	g_config.nod_refresh[s_filter_msg] = ((uint16_t)msg->data[6] << 8)
+		| msg->data[7];
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_divider(can_msg_t* msg)
+{
+	if (msg->data[4] >= NOD_NUM_MESSAGES)
+		return MCS_INVALID;
+
+	// message index and output rate divider
+	s_filter_msg = msg->data[4];
+	g_config.nod_divider[s_filter_msg] = msg->data[5];
+	s_filter[s_filter_msg].count = 0;
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_telem(can_msg_t* msg)
+{
+	// raw sample stream on the uart on/off
+	g_config.telemetry = msg->data[4] ? 1 : 0;
+	telem_enable(g_config.telemetry);
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_qnh(can_msg_t* msg)
+{
+	// baro correction in Pa
+	uint32_t qnh = ((uint32_t)msg->data[4] << 24)
+		| ((uint32_t)msg->data[5] << 16)
+		| ((uint16_t)msg->data[6] << 8) | msg->data[7];
+	if (airdata_set_qnh(qnh))
+		return MCS_INVALID;
+	g_config.qnh = qnh;
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_filter(can_msg_t* msg)
+{
+	// channel, filter mode and shift
+	if (filter_set(msg->data[4], msg->data[5], msg->data[6]))
+		return MCS_INVALID;
+	config_changed();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_prof_reset(can_msg_t* msg)
+{
+	// clear the run time statistics
+	prof_reset();
+	return MCS_DONE;
+}
+
+static enum mcs_result mcs_jitter_reset(can_msg_t* msg)
+{
+	// clear the frame timing histograms
+	jitter_reset();
+	return MCS_DONE;
+}
+
+// MCS code, no set function means we don't answer it
+struct mcs_entry {
+	uint8_t request;                // payload type, or SVC_ANY_TYPE
+	canaero_data_type_t type;
+	get_nod_msg_data_fn* fn;
+	mcs_set_fn* set;
+};
+
+#define MCS_TABLE(code, request, type, fn, set) \
+	[code] = {request, type, fn, set},
+static const struct mcs_entry k_mcs[] PROGMEM = {
+	MCS_SERVICES(MCS_TABLE)
+};
+
 // MCS service reply
 // set module configuration
 int reply_mcs(canaero_init_t* proto, service_msg_id_t* svc, can_msg_t* msg)
 {
-	/* Module Configuration Service Request code 0 */
-	static canaero_svc_msg_tmpl_t t0 = {UCHAR2, 13, 0, get_mis0_data};
-	
-	/* Module Configuration Service Request code 1 */
-	static canaero_svc_msg_tmpl_t t1 = {NODATA, 13, 1, 0};
-	
-	/* Module Configuration Service Request code 10 */
-	static canaero_svc_msg_tmpl_t t10 = {UCHAR4, 13, 10, get_mis10_data};
-	
 	/* Module Configuration Service Request invalid code */
-	static canaero_svc_msg_tmpl_t invalid = {NODATA, 13, 255, 0};
-		
+	static const canaero_svc_msg_tmpl_t invalid PROGMEM = {NODATA, 13, 255, 0};
+
+	uint8_t code = msg->data[3];
+	enum mcs_result res = MCS_INVALID;
 	uint8_t snd_stat;
+	struct mcs_entry e;
 
-	// the message code gives the type of module configuration requested
-	switch (msg->data[3]) {
-	case 0:
-		// ensure the data format is as we expect
-		if (msg->data[1] != UCHAR2)
-			return canaero_send_svc_reply_message(proto, svc, &invalid);
-	
-		// set listen/active state
-		if (msg->data[4])
-			g_state = AHRSLISTEN;
-		else
-			g_state = AHRSACTIVE;
-		// second byte is filtering on/off
-		uint8_t reset = 0;
-		if (CAN_config.can_settings.filters.filtering_on != msg->data[5])
-		{
-			// setup the filters as setting is changed
-			if (msg->data[5])
-				canaero_high_priority_service_filters(&CAN_config);
-			else
-				canaero_no_filters(&CAN_config);
-			reset = 1;
-		}
+	if (code < sizeof(k_mcs) / sizeof(k_mcs[0]))
+		memcpy_P(&e, &k_mcs[code], sizeof(e));
+	else
+		e.set = 0;
 
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t0);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MCS code 0"));
-#endif
-		if (reset) {
-			// reinitialize the canaero stack
-			errcode = canaero_init(&CAN_config, CAN_config.can_dev);
-			if (errcode == CAN_FAILINIT)
-				offline();
-		}
-		break;
-	case 1:
-		// ensure the data format is as we expect
-		if (msg->data[1] != UCHAR2)
-			return canaero_send_svc_reply_message(proto, svc, &invalid);
-
-		// reset the message counters, and clear tx buffers, if requested
-		if (msg->data[5])
-			can_clear_tx_buffers(CAN_config.can_dev);
-		if (msg->data[4])
-			canaero_reset_nod_message_sequence(&CAN_config);
-
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t1);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MCS code 1"));
-#endif
-		break;
-	case 10:
-		// ensure the data format is as we expect
-		if (msg->data[1] != UCHAR4)
-			return canaero_send_svc_reply_message(proto, svc, &invalid);
-	
-		// read and set the configuration variables
-		g_accelerometer_enabled = msg->data[4];
-		g_gyros_enabled = msg->data[5];
-		g_static_air_enabled = msg->data[6];
-		g_dynamic_air_enabled = msg->data[7];
-		
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &t10);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MCS code 10"));
-#endif
-		break;
-	default:
-		// we don't respond to these message codes
-		snd_stat = canaero_send_svc_reply_message(proto, svc, &invalid);
-#ifdef CANAERODEBUG
-		puts_P(PSTR("replied to MCS code unknown"));
-#endif
+	// ensure the data format is as we expect, and that we answer the code
+	if (e.set && (e.request == SVC_ANY_TYPE || e.request == msg->data[1]))
+		res = e.set(msg);
+
+	if (res == MCS_INVALID) {
+		snd_stat = reply_svc_P(proto, svc, &invalid);
+	} else {
+		canaero_svc_msg_tmpl_t t = {e.type, 13, code, e.fn};
+		snd_stat = canaero_send_svc_reply_message(proto, svc, &t);
 	}
-	
+
+	if (res == MCS_REINIT) {
+		// reinitialize the canaero stack
+		errcode = canaero_init(&CAN_config, CAN_config.can_dev);
+		if (errcode == CAN_FAILINIT)
+			offline();
+	}
+
+	trace(TRACE_MCS_REPLY, code, snd_stat, 0);
 	return snd_stat;
 }
 
@@ -1,12 +1,59 @@
 #ifndef CANAEROMSG_H_
 #define CANAEROMSG_H_
 
+#include <inttypes.h>
 #include "canaero.h"
+#include "canaerospec.h"
+
+// index of the messages in nod_msg_templates, see canaerospec.h
+#define NOD_INDEX(a, name, id, type, fn, value, range, div) name,
+enum nod_index {
+	NOD_MESSAGES(NOD_INDEX, 0)
+	NOD_NUM_MESSAGES
+};
+
+// send ranges
+#define NOD_RANGE_NAME(r) NOD_RANGE_##r,
+enum nod_range {
+	NOD_RANGES(NOD_RANGE_NAME)
+	NOD_NUM_RANGES
+};
+
+// NOD_<range>_FIRST counts the messages of the ranges before it,
+// NOD_<range>_END adds its own
+#define NOD_BEFORE(r, name, id, type, fn, value, range, div) \
+	+ (NOD_RANGE_##range < (r))
+#define NOD_UPTO(r, name, id, type, fn, value, range, div) \
+	+ (NOD_RANGE_##range <= (r))
+#define NOD_RANGE_BOUNDS(r) \
+	NOD_##r##_FIRST = 0 NOD_MESSAGES(NOD_BEFORE, NOD_RANGE_##r), \
+	NOD_##r##_END = 0 NOD_MESSAGES(NOD_UPTO, NOD_RANGE_##r),
+enum {
+	NOD_RANGES(NOD_RANGE_BOUNDS)
+};
+
+// messages below this have a value for the deadband filter
+#define NOD_DEADBAND_END    NOD_COMPACT_ACCEL_FIRST
+
+// longest silence of a message with a deadband, unless set over MCS
+#define NOD_REFRESH_MS      1000
+
+// rate of the frame the messages are sent from, the dividers count these
+#define NOD_BASE_HZ         80
 
 // normal operating data message templates
 extern canaero_msg_tmpl_t nod_msg_templates[];
 extern int num_nod_templates;
 
+// reset the output rate divider counts
+extern void nod_init(void);
+
+// send the messages first .. end-1, called every base frame. A message
+// goes out every 'divider' frames, 0 turns it off. A message with a
+// deadband is only sent if its raw value moved by the deadband, or it
+// has been silent for longer than its refresh time
+extern void nod_send_messages(uint8_t first, uint8_t end);
+
 // service message reply functions
 extern reply_svc_fn* nsl_dispatcher_fn_array[];
 
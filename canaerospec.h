@@ -0,0 +1,155 @@
+#ifndef CANAEROSPEC_H_
+#define CANAEROSPEC_H_
+
+/*-----------------------------------------------------------------------*/
+/*
+ * message and service catalogue
+ *
+ * every normal operating data message and every MIS/MCS code of the
+ * unit is listed here, and only here. The lists are X-macros, the
+ * including file defines X to pick the columns it needs:
+ *   canaeromsg.h  message index, send ranges
+ *   canaeromsg.c  message templates, deadband values, service tables
+ *   config.c      default rate dividers
+ *   bench/bench.c names, codes and a request for each MCS code
+ * the order and range checks are static assertions in canaeromsg.c,
+ * a mistake here fails the build instead of sending the wrong message
+ */
+
+/*-----------------------------------------------------------------------*/
+
+/*
+ * normal operating data messages, in table order
+ *
+ * X(arg, index, can id, payload type, data function, deadband value,
+ *   send range, default rate divider)
+ *
+ * arg is passed through from the list macro. The payload types
+ * NOD_*_TYPE depend on FLOAT_NOD_DATA, see canaeromsg.c. The deadband
+ * value is the raw quantity the change filter looks at, the packed
+ * vectors have none. Messages of a send range must be adjacent, and
+ * the ranges in the order of NOD_RANGES.
+ */
+#define NOD_MESSAGES(X, a) \
+	/* sensor data messages, through the channel filters */ \
+	X(a, NOD_CYCLE_TIME,   0x100, USHORT,           get_cycle_time, \
+	  g_cycle_time,                       CYCLE,         1) \
+	X(a, NOD_LONG_ACCEL,   0x101, NOD_SHORT_TYPE,   get_body_long_accel, \
+	  filter_output(FILTER_LONG_ACCEL),   ACCEL,         1) \
+	X(a, NOD_LAT_ACCEL,    0x102, NOD_SHORT_TYPE,   get_body_lat_accel, \
+	  filter_output(FILTER_LAT_ACCEL),    ACCEL,         1) \
+	X(a, NOD_NORM_ACCEL,   0x103, NOD_SHORT_TYPE,   get_body_norm_accel, \
+	  filter_output(FILTER_NORM_ACCEL),   ACCEL,         1) \
+	X(a, NOD_PITCH_RATE,   0x104, NOD_SHORT_TYPE,   get_body_pitch_rate, \
+	  filter_output(FILTER_PITCH_RATE),   GYRO,          1) \
+	X(a, NOD_ROLL_RATE,    0x105, NOD_SHORT_TYPE,   get_body_roll_rate, \
+	  filter_output(FILTER_ROLL_RATE),    GYRO,          1) \
+	X(a, NOD_YAW_RATE,     0x106, NOD_SHORT_TYPE,   get_body_yaw_rate, \
+	  filter_output(FILTER_YAW_RATE),     GYRO,          1) \
+	X(a, NOD_STATIC_PRESS, 0x108, NOD_LONG_TYPE,    get_static_pressure, \
+	  filter_output(FILTER_STATIC_PRESS), PRESSURE,      4) \
+	X(a, NOD_TOTAL_PRESS,  0x10A, NOD_LONG_TYPE,    get_total_pressure, \
+	  filter_output(FILTER_TOTAL_PRESS),  PRESSURE,      4) \
+	/* computed by the attitude estimator, heading is gyro only */ \
+	X(a, NOD_PITCH_ANGLE,  311,   NOD_ANGLE_TYPE,   get_body_pitch_angle, \
+	  attitude_angle(ATT_PITCH),          ATTITUDE,      1) \
+	X(a, NOD_ROLL_ANGLE,   312,   NOD_ANGLE_TYPE,   get_body_roll_angle, \
+	  attitude_angle(ATT_ROLL),           ATTITUDE,      1) \
+	X(a, NOD_HEADING,      321,   NOD_HEADING_TYPE, get_heading_angle, \
+	  (uint16_t)attitude_angle(ATT_HEADING), ATTITUDE,   1) \
+	/* computed by the air data computer, cm and cm/s, see airdata.h */ \
+	X(a, NOD_ALTITUDE_RATE, 314,  NOD_SHORT_TYPE,   get_altitude_rate, \
+	  airdata_vertical_speed(),           AIRDATA,       4) \
+	X(a, NOD_IAS,          315,   NOD_SHORT_TYPE,   get_indicated_airspeed, \
+	  airdata_airspeed(),                 AIRDATA,       4) \
+	X(a, NOD_BARO_ALTITUDE, 320,  NOD_LONG_TYPE,    get_baro_altitude, \
+	  airdata_baro_altitude(),            AIRDATA,       4) \
+	X(a, NOD_STD_ALTITUDE, 322,   NOD_LONG_TYPE,    get_standard_altitude, \
+	  airdata_altitude(),                 AIRDATA,       4) \
+	/* vibration spectrum, user defined ids, see vib.h */ \
+	X(a, NOD_VIB_FREQUENCY, 1800, NOD_SHORT_TYPE,   get_vibration_frequency, \
+	  vib_frequency(),                    VIBRATION,    16) \
+	X(a, NOD_VIB_AMPLITUDE, 1801, NOD_SHORT_TYPE,   get_vibration_amplitude, \
+	  vib_amplitude(),                    VIBRATION,    16) \
+	X(a, NOD_VIB_RMS,      1802,  NOD_SHORT_TYPE,   get_vibration_rms, \
+	  vib_rms(),                          VIBRATION,    16) \
+	/* compact mode, packed raw vectors */ \
+	X(a, NOD_ACCEL_VECTOR, 0x10E, BLONG,            get_body_accel_vector, \
+	  0,                                  COMPACT_ACCEL, 1) \
+	X(a, NOD_RATE_VECTOR,  0x10F, BLONG,            get_body_rate_vector, \
+	  0,                                  COMPACT_GYRO,  1)
+
+/*
+ * send ranges, in table order. Each gives NOD_<range>_FIRST and
+ * NOD_<range>_END for nod_send_messages()
+ */
+#define NOD_RANGES(R) \
+	R(CYCLE) \
+	R(ACCEL) \
+	R(GYRO) \
+	R(PRESSURE) \
+	R(ATTITUDE) \
+	R(AIRDATA) \
+	R(VIBRATION) \
+	R(COMPACT_ACCEL) \
+	R(COMPACT_GYRO)
+
+/*-----------------------------------------------------------------------*/
+
+/*
+ * MIS codes
+ *
+ * X(code, rep, count, reply type, data function, select function)
+ *
+ * a block of codes has rep > 1, the select function is called with
+ * the offset into the block before the reply is built. rep is the
+ * literal block size (1, 10, 11 or 16, see SVC_REP in canaeromsg.c),
+ * count the module's own constant, they are checked to match.
+ */
+#define MIS_SERVICES(X) \
+	X(0,                  1,  1,               UCHAR2,  get_mis0_data, 0) \
+	X(1,                  1,  1,               UCHAR4,  get_mis1_data, 0) \
+	X(2,                  1,  1,               USHORT2, watchdog_mis2_data, 0) \
+	X(3,                  1,  1,               USHORT2, watchdog_mis3_data, 0) \
+	X(10,                 1,  1,               UCHAR4,  get_mis10_data, 0) \
+	X(11,                 1,  1,               USHORT2, get_mis11_data, 0) \
+	X(12,                 1,  1,               UCHAR,   get_mis12_data, 0) \
+	X(STACKMON_MIS_STACK, 1,  1,               USHORT2, stackmon_mis_stack_data, 0) \
+	X(STACKMON_MIS_RAM,   1,  1,               USHORT2, stackmon_mis_ram_data, 0) \
+	X(TELEM_MIS_ENABLE,   1,  1,               UCHAR,   telem_mis_data, 0) \
+	X(AIRDATA_MIS_QNH,    1,  1,               ULONG,   airdata_mis_qnh_data, 0) \
+	X(PROF_MIS_MINMAX,    11, PROF_NUM_STAGES, USHORT2, prof_mis_minmax_data, \
+	  prof_select) \
+	X(PROF_MIS_AVG,       11, PROF_NUM_STAGES, USHORT2, prof_mis_avg_data, \
+	  prof_select) \
+	X(JITTER_MIS_BUCKET,  16, JITTER_BUCKETS,  USHORT2, jitter_mis_bucket_data, \
+	  jitter_select) \
+	X(JITTER_MIS_MISSES,  1,  1,               USHORT2, jitter_mis_misses_data, 0) \
+	X(JITTER_MIS_SCHED,   1,  1,               USHORT2, jitter_mis_sched_data, 0)
+
+/*
+ * MCS codes
+ *
+ * X(code, request type, reply type, reply data function, set function)
+ *
+ * the set function applies the request, see mcs_set_fn. A request
+ * type of SVC_ANY_TYPE accepts any payload
+ */
+#define MCS_SERVICES(X) \
+	X(0,                  UCHAR2,       UCHAR2,  get_mis0_data,  mcs_state) \
+	X(1,                  UCHAR2,       NODATA,  0,              mcs_counters) \
+	X(10,                 UCHAR4,       UCHAR4,  get_mis10_data, mcs_sensors) \
+	X(12,                 UCHAR,        UCHAR,   get_mis12_data, mcs_compact) \
+	X(13,                 USHORT2,      USHORT2, get_mcs13_data, mcs_deadband) \
+	X(14,                 USHORT2,      USHORT2, get_mcs14_data, mcs_refresh) \
+	X(15,                 UCHAR2,       UCHAR2,  get_mcs15_data, mcs_divider) \
+	X(TELEM_MCS_ENABLE,   UCHAR,        UCHAR,   telem_mis_data, mcs_telem) \
+	X(AIRDATA_MCS_QNH,    ULONG,        ULONG,   airdata_mis_qnh_data, mcs_qnh) \
+	X(FILTER_MCS_SET,     UCHAR4,       UCHAR4,  filter_mcs_data, mcs_filter) \
+	X(PROF_MCS_RESET,     SVC_ANY_TYPE, NODATA,  0,              mcs_prof_reset) \
+	X(JITTER_MCS_RESET,   SVC_ANY_TYPE, NODATA,  0,              mcs_jitter_reset)
+
+// request type that isn't checked
+#define SVC_ANY_TYPE        0xff
+
+#endif  // CANAEROSPEC_H_
@@ -0,0 +1,177 @@
+#include <inttypes.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+#include "config.h"
+#include "airdata.h"
+
+/*-----------------------------------------------------------------------*/
+
+struct config g_config;
+
+// rate dividers of the defaults, see canaerospec.h
+#define NOD_DIVIDER(a, name, id, type, fn, value, range, div) [name] = div,
+static const uint8_t k_nod_divider[NOD_NUM_MESSAGES] PROGMEM = {
+	NOD_MESSAGES(NOD_DIVIDER, 0)
+};
+
+STATIC_ASSERT(config_record,
+			  sizeof(struct config_record) == sizeof(struct config) + 4);
+STATIC_ASSERT(config_slots, CONFIG_SLOTS >= 2);
+
+// slot and sequence number of the newest record, s_stored if it is
+// one of this layout
+static uint8_t s_slot;
+static uint8_t s_seq;
+static uint8_t s_stored;
+
+// write back state, s_pos counts the bytes of the record written
+static uint8_t s_dirty;
+static uint8_t s_writing;
+static uint8_t s_pos;
+static uint16_t s_crc;
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t* slot_addr(uint8_t slot)
+{
+	return (uint8_t*)(EEPROM_CONFIG_ADDR
+					  + slot * sizeof(struct config_record));
+}
+
+static void config_defaults(void)
+{
+	g_config.active = 0;
+	g_config.filtering = 1;
+	g_config.accel_enabled = 1;
+	g_config.gyros_enabled = 1;
+	g_config.static_air_enabled = 1;
+	g_config.dynamic_air_enabled = 1;
+	g_config.compact_nod = 0;
+#ifdef TELEMETRY
+	g_config.telemetry = 1;
+#else
+	g_config.telemetry = 0;
+#endif
+	g_config.qnh = AIRDATA_QNH_STD;
+	for (uint8_t i=0; i<FILTER_NUM_CHANNELS; ++i) {
+		g_config.filter[i].mode = FILTER_NONE;
+		g_config.filter[i].shift = 0;
+	}
+	for (uint8_t i=0; i<NOD_NUM_MESSAGES; ++i) {
+		g_config.nod_divider[i] = pgm_read_byte(&k_nod_divider[i]);
+		g_config.nod_deadband[i] = 0;
+		g_config.nod_refresh[i] = 0;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t config_init(void)
+{
+	uint8_t found = 0;
+
+	// one pass over the slots, keep the newest good record
+	for (uint8_t slot=0; slot<CONFIG_SLOTS; ++slot) {
+		struct config_record r;
+		eeprom_read_block(&r, slot_addr(slot), sizeof(r));
+
+		uint16_t crc = 0xffff;
+		const uint8_t* p = (const uint8_t*)&r;
+		for (uint8_t i=0; i<sizeof(r) - sizeof(r.crc); ++i)
+			crc = _crc16_update(crc, p[i]);
+		if (crc != r.crc || r.version != CONFIG_VERSION)
+			continue;
+		// sequence numbers wrap, newer is less than half way round
+		if (found && (int8_t)(r.seq - s_seq) <= 0)
+			continue;
+		g_config = r.cfg;
+		s_slot = slot;
+		s_seq = r.seq;
+		found = 1;
+	}
+
+	s_dirty = 0;
+	s_writing = 0;
+	s_stored = found;
+	if (found)
+		return 0;
+
+	// next record goes to slot 0
+	config_defaults();
+	s_slot = CONFIG_SLOTS - 1;
+	s_seq = 0xff;
+	return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// g_config is the newest record
+static uint8_t config_stored(void)
+{
+	const uint8_t* p = (const uint8_t*)&g_config;
+	const uint8_t* addr = slot_addr(s_slot);
+
+	if (!s_stored)
+		return 0;
+	for (uint8_t i=0; i<sizeof(struct config); ++i)
+		if (eeprom_read_byte(addr + i) != p[i])
+			return 0;
+	return 1;
+}
+
+void config_changed(void)
+{
+	s_dirty = 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void config_task(void)
+{
+	if (!eeprom_is_ready())
+		return;
+
+	if (s_writing && s_dirty) {
+		// g_config changed under the record, start it again in the
+		// same slot so it never has old and new bytes under one crc
+		s_dirty = 0;
+		s_pos = 0;
+		s_crc = 0xffff;
+	}
+
+	if (!s_writing) {
+		if (!s_dirty)
+			return;
+		// start a record in the next slot
+		s_dirty = 0;
+		if (config_stored())
+			return;
+		s_writing = 1;
+		s_slot = (s_slot + 1 == CONFIG_SLOTS) ? 0 : s_slot + 1;
+		++s_seq;
+		s_pos = 0;
+		s_crc = 0xffff;
+	}
+
+	uint8_t* addr = slot_addr(s_slot) + s_pos;
+	uint8_t b;
+	if (s_pos < sizeof(struct config)) {
+		b = ((const uint8_t*)&g_config)[s_pos];
+	} else if (s_pos == sizeof(struct config)) {
+		b = s_seq;
+	} else if (s_pos == sizeof(struct config) + 1) {
+		b = CONFIG_VERSION;
+	} else if (s_pos == sizeof(struct config) + 2) {
+		b = s_crc;
+	} else {
+		b = s_crc >> 8;
+		s_writing = 0;
+		s_stored = 1;
+	}
+	if (s_pos < sizeof(struct config) + 2)
+		s_crc = _crc16_update(s_crc, b);
+	eeprom_update_byte(addr, b);
+	++s_pos;
+}
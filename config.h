@@ -0,0 +1,67 @@
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <inttypes.h>
+#include "defs.h"
+#include "canaeromsg.h"
+#include "filter.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * persistent configuration, wear leveled
+ *
+ * g_config is the ram copy of everything set over MCS. A change is
+ * marked with config_changed(), config_task() then writes a new record
+ * one byte per call, so it never waits on the eeprom. A change while
+ * a record is written starts that record again. A change that leaves
+ * g_config as the newest record is not written. Records go to
+ * the next slot of the eeprom area each time, with a sequence number,
+ * the layout version and a crc. At start up the newest record with a
+ * good crc and CONFIG_VERSION is loaded, or the defaults if there is
+ * none.
+ */
+
+// layout version of struct config, bump it on a change
+#define CONFIG_VERSION          1
+
+// settings
+struct config {
+	uint8_t active;                         // AHRSACTIVE after start up
+	uint8_t filtering;                      // high priority filters
+	uint8_t accel_enabled;
+	uint8_t gyros_enabled;
+	uint8_t static_air_enabled;
+	uint8_t dynamic_air_enabled;
+	uint8_t compact_nod;                    // packed vector messages
+	uint8_t telemetry;                      // uart raw sample stream
+	uint32_t qnh;                           // baro correction, Pa
+	struct filter_setting filter[FILTER_NUM_CHANNELS];
+	uint8_t nod_divider[NOD_NUM_MESSAGES];  // see nod_send_messages()
+	uint16_t nod_deadband[NOD_NUM_MESSAGES];
+	uint16_t nod_refresh[NOD_NUM_MESSAGES];
+};
+
+// eeprom record, a slot of the config area, no padding on the host
+struct config_record {
+	struct config cfg;
+	uint8_t seq;
+	uint8_t version;                        // CONFIG_VERSION
+	uint16_t crc;                           // _crc16_update, all above
+};
+
+// slots in the eeprom area
+#define CONFIG_SLOTS (EEPROM_CONFIG_SIZE / sizeof(struct config_record))
+
+// the current settings
+extern struct config g_config;
+
+// load the newest good record, returns 1 if the defaults are used
+extern uint8_t config_init(void);
+
+// g_config was changed, write it back
+extern void config_changed(void);
+
+// write back the next byte, called from the main loop
+extern void config_task(void);
+
+#endif  // CONFIG_H_
@@ -20,15 +20,59 @@
 /* in this hardware, we are using the second serial port */
 #define UART1                           1
 
-/* define the size of the fifo buffers for the uart */
+/* define the size of the fifo buffers for the uart, nothing reads
+ * stdin in normal operation so the receive side is kept small */
 #define TX_FIFO_BUFFER_SIZE             128
-#define RX_FIFO_BUFFER_SIZE             64
+#define RX_FIFO_BUFFER_SIZE             16
 
 /* define baud rate for serial comm */
 #define BAUD                            230400
 
 /*-----------------------------------------------------------------------*/
 
+/* sensor scaling, the drivers hand over raw counts */
+
+/* l3g4200d at 250 dps full scale, micro degrees/s per lsb */
+#define GYRO_UDPS_PER_LSB               8750L
+
+/* adxl345 in full resolution mode */
+#define ACCEL_LSB_PER_G                 256L
+
+/*
+ * compact NOD mode packs a 3 axis vector into one BLONG payload,
+ * 11/11/10 bits msb first, each axis the raw count shifted right.
+ * accel: 64 lsb/g, +-16g (normal +-8g)
+ * rates: 280 mdps/lsb, +-286 dps (yaw +-143 dps)
+ */
+#define COMPACT_ACCEL_SHIFT             2
+#define COMPACT_GYRO_SHIFT              5
+
+/*
+ * NOD payloads are the raw counts, FLOAT payloads are selected with
+ * FLOAT_NOD_DATA on the compiler command line (AHRS_FLOAT_NOD_DATA in
+ * cmake, FLOAT_NOD_DATA in the Makefile), that also links libm
+ */
+
+/*-----------------------------------------------------------------------*/
+
+/* eeprom layout, fixed addresses so settings survive a reflash */
+
+/* wear leveled configuration records, struct config_record */
+#define EEPROM_CONFIG_ADDR              0x200
+#define EEPROM_CONFIG_SIZE              0x200
+
+/* inertial sensor calibration, struct calib_eeprom */
+#define EEPROM_CALIB_ADDR               0x140
+#define EEPROM_CALIB_MAGIC              0xc1
+
+/*-----------------------------------------------------------------------*/
+
+/* compile time check, a false condition is a negative array size */
+#define STATIC_ASSERT(name, cond) \
+	typedef char static_assert_##name[(cond) ? 1 : -1]
+
+/*-----------------------------------------------------------------------*/
+
 /* DEBUGGING */
        
 #define AT90CANDEBUG                    1
@@ -121,9 +165,20 @@
 #define PIN_GYROINT    PINE
 #define P_GYROINT      7
 
+/* gyro chip select, driven by the FIFO bursts of gyro.c. It has to be
+ * the pin the ../libs l3g4200d driver selects, which isn't in this
+ * tree, so only the host (its simulated spi) sets it. A board defines
+ * DDR_, PORT_ and P_GYROCS here to read the gyro FIFO, without them
+ * the gyro is read through the driver, with SENSOR_FIFO as well */
+#ifndef __AVR__
+#define P_GYROCS       0
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* I2C addresses */
 #define ADXL345_ADDRESS (0x53 << 1)
+/* both bmp085 share one address, XCLR selects which one answers */
+#define BMP085_I2C_ADDRESS (0x77 << 1)
 
 /*-----------------------------------------------------------------------*/
 #endif  // DEFS_H_
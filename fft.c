@@ -0,0 +1,140 @@
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+
+#include "fft.h"
+
+/*-----------------------------------------------------------------------*/
+
+// complex points and butterflies of a stage as shifts
+#define FFT_POINTS_LOG2   (FFT_LOG2 - 1)
+#define FFT_STAGE_LOG2    (FFT_LOG2 - 2)
+
+// sin(2 pi i / FFT_SIZE) in Q15 for a quarter turn, every second entry
+// of the fixmath sine table
+static const int16_t k_twiddle[FFT_SIZE / 4 + 1] PROGMEM = {
+	0, 1608, 3212, 4808, 6393, 7962, 9512, 11039,
+	12540, 14010, 15447, 16846, 18205, 19520, 20788, 22006,
+	23170, 24279, 25330, 26320, 27246, 28106, 28899, 29622,
+	30274, 30853, 31357, 31786, 32138, 32413, 32610, 32729,
+	32767,
+};
+
+/*-----------------------------------------------------------------------*/
+
+// sine and cosine of 2 pi i / FFT_SIZE for i up to a half turn
+
+static int16_t fft_sin(uint8_t i)
+{
+	if (i > FFT_SIZE / 4)
+		i = FFT_SIZE / 2 - i;
+	return pgm_read_word(&k_twiddle[i]);
+}
+
+static int16_t fft_cos(uint8_t i)
+{
+	if (i > FFT_SIZE / 4)
+		return -(int16_t)pgm_read_word(&k_twiddle[i - FFT_SIZE / 4]);
+	return pgm_read_word(&k_twiddle[FFT_SIZE / 4 - i]);
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t fft_scale(uint16_t dev)
+{
+	uint8_t shift = 0;
+	while (shift < 14 && ((uint32_t)dev << (shift + 1)) <= FFT_HEADROOM)
+		++shift;
+	return shift;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void fft_window(int16_t* x, uint8_t first, uint8_t count,
+				int16_t mean, uint8_t shift)
+{
+	for (uint8_t i=first; i<first+count; ++i) {
+		// hann, (1 - cos) / 2, symmetric about the middle
+		uint8_t j = (i <= FFT_SIZE / 2) ? i : FFT_SIZE - i;
+		int32_t w = (32768L - fft_cos(j)) >> 1;
+		int16_t d = (int16_t)((x[i] - mean) << shift);
+		x[i] = (int16_t)(((int32_t)d * w + 16384) >> 15);
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void fft_bitrev(int16_t* x)
+{
+	for (uint8_t i=1; i<FFT_BINS-1; ++i) {
+		uint8_t r = 0;
+		for (uint8_t b=0, v=i; b<FFT_POINTS_LOG2; ++b, v >>= 1)
+			r = (r << 1) | (v & 1);
+		if (r > i) {
+			int16_t re = x[i * 2];
+			int16_t im = x[i * 2 + 1];
+			x[i * 2] = x[r * 2];
+			x[i * 2 + 1] = x[r * 2 + 1];
+			x[r * 2] = re;
+			x[r * 2 + 1] = im;
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void fft_butterflies(int16_t* x, uint8_t first, uint8_t count)
+{
+	for (uint8_t n=first; n<first+count; ++n) {
+		// stage s pairs points half = 2^s apart, the twiddle steps
+		// through a half turn over the pair's group
+		uint8_t s = n >> FFT_STAGE_LOG2;
+		uint8_t k = n & ((1 << FFT_STAGE_LOG2) - 1);
+		uint8_t j = k & ((1 << s) - 1);
+		uint8_t i = ((k >> s) << (s + 1)) + j;
+		int16_t* a = &x[i * 2];
+		int16_t* b = &x[(i + (1 << s)) * 2];
+		uint8_t tw = j << (FFT_POINTS_LOG2 - s);
+		int16_t c = fft_cos(tw);
+		int16_t sn = fft_sin(tw);
+
+		// b * (c - j sn), then halve both outputs
+		int32_t tr = ((int32_t)b[0] * c + (int32_t)b[1] * sn) >> 15;
+		int32_t ti = ((int32_t)b[1] * c - (int32_t)b[0] * sn) >> 15;
+		int32_t ar = a[0];
+		int32_t ai = a[1];
+		a[0] = (int16_t)((ar + tr + 1) >> 1);
+		a[1] = (int16_t)((ai + ti + 1) >> 1);
+		b[0] = (int16_t)((ar - tr + 1) >> 1);
+		b[1] = (int16_t)((ai - ti + 1) >> 1);
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint32_t fft_power(const int16_t* x, uint8_t k)
+{
+	const int16_t* z = &x[k * 2];
+	const int16_t* m = &x[(FFT_BINS - k) * 2];
+
+	// even samples e = (Z[k] + Z*[M-k]) / 2, odd d = -j (Z[k] - Z*[M-k]) / 2
+	int32_t er = ((int32_t)z[0] + m[0]) >> 1;
+	int32_t ei = ((int32_t)z[1] - m[1]) >> 1;
+	int32_t dr = ((int32_t)z[1] + m[1]) >> 1;
+	int32_t di = ((int32_t)m[0] - z[0]) >> 1;
+
+	// X[k] = e + d (c - j s)
+	int16_t c = fft_cos(k);
+	int16_t s = fft_sin(k);
+	int32_t yr = er + ((dr * c + di * s) >> 15);
+	int32_t yi = ei + ((di * c - dr * s) >> 15);
+	return (uint32_t)(yr * yr) + (uint32_t)(yi * yi);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void fft_real(int16_t* x, int16_t mean, uint8_t shift)
+{
+	fft_window(x, 0, FFT_SIZE, mean, shift);
+	fft_bitrev(x);
+	fft_butterflies(x, 0, FFT_BUTTERFLIES);
+}
@@ -0,0 +1,64 @@
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * fixed point FFT of a block of real samples, no floating point
+ *
+ * the FFT_SIZE samples are taken as FFT_BINS complex points, even
+ * samples real and odd imaginary, so a radix-2 FFT of half the size
+ * does the work in place and fft_power() sorts the two halves out
+ * into the bins of the real transform. The samples are 256 bytes of
+ * ram and nothing else is needed.
+ *
+ * fft_window() takes off the mean, scales the block up by 2^shift so
+ * the largest deviation uses the headroom (fft_scale()), and applies
+ * a Hann window. Every stage of the transform halves the points, so
+ * nothing can overflow and sqrt(fft_power()) of a sine is half its
+ * amplitude (the window gain), in scaled input units. Twiddles and
+ * window are Q15, from one quarter sine table in flash.
+ *
+ * the transform comes in pieces so it can run in slices: fft_window()
+ * takes a range of samples, fft_butterflies() a range of the
+ * FFT_BUTTERFLIES butterflies in order, fft_power() one bin.
+ * fft_real() does it all at once. Against a double precision
+ * transform of the same windowed block, the bin amplitudes are within
+ * 5 lsb of the 16384 full scale. Accuracy and speed on the host are
+ * checked by host/fftbench.c, cycle counts are the fft_* lines of
+ * "make bench".
+ */
+
+#define FFT_LOG2          7
+#define FFT_SIZE          (1 << FFT_LOG2)       // real samples
+#define FFT_BINS          (FFT_SIZE / 2)        // complex points, bins
+
+// butterflies of the complex transform
+#define FFT_BUTTERFLIES   ((FFT_LOG2 - 1) * FFT_BINS / 2)
+
+// largest scaled deviation from the mean
+#define FFT_HEADROOM      16383
+
+// shift that scales a largest deviation 'dev' up to the headroom
+extern uint8_t fft_scale(uint16_t dev);
+
+// window samples [first, first + count) in place, after taking off
+// 'mean' and scaling by 2^shift
+extern void fft_window(int16_t* x, uint8_t first, uint8_t count,
+					   int16_t mean, uint8_t shift);
+
+// put the complex points in bit reversed order, before the butterflies
+extern void fft_bitrev(int16_t* x);
+
+// butterflies [first, first + count) of the FFT_BUTTERFLIES, in order
+extern void fft_butterflies(int16_t* x, uint8_t first, uint8_t count);
+
+// power of bin k, 1 .. FFT_BINS - 1, of the transformed block. Bin k
+// is k * sample rate / FFT_SIZE
+extern uint32_t fft_power(const int16_t* x, uint8_t k);
+
+// the whole transform at once
+extern void fft_real(int16_t* x, int16_t mean, uint8_t shift);
+
+#endif  // FFT_H_
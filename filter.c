@@ -0,0 +1,143 @@
+#include <inttypes.h>
+
+#include "filter.h"
+#include "config.h"
+
+/*-----------------------------------------------------------------------*/
+
+// low pass stages keep 8 fraction bits
+#define FILTER_FRAC             8
+
+// state of a channel, the stages and the held output
+struct filter_state {
+	int32_t hist[2];        // median, the last two inputs
+	int32_t stage[2];       // low pass Q8, or the average sum in [0]
+	int32_t out;
+	uint8_t count;          // samples in the average sum
+	uint8_t primed;         // history and stages hold a sample
+};
+
+static struct filter_state s_state[FILTER_NUM_CHANNELS];
+
+// channel last set over MCS, for the reply
+static uint8_t s_channel;
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t filter_valid(uint8_t mode, uint8_t shift)
+{
+	uint8_t kind = mode & ~FILTER_MEDIAN;
+
+	if (kind >= FILTER_NUM_KINDS)
+		return 0;
+	if (kind == FILTER_NONE)
+		return shift == 0;
+	return shift >= 1 && shift <= FILTER_MAX_SHIFT;
+}
+
+void filter_init(void)
+{
+	for (uint8_t i=0; i<FILTER_NUM_CHANNELS; ++i) {
+		struct filter_setting* f = &g_config.filter[i];
+		if (!filter_valid(f->mode, f->shift)) {
+			f->mode = FILTER_NONE;
+			f->shift = 0;
+		}
+		s_state[i].primed = 0;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t filter_set(uint8_t channel, uint8_t mode, uint8_t shift)
+{
+	if (channel >= FILTER_NUM_CHANNELS || !filter_valid(mode, shift))
+		return 1;
+	g_config.filter[channel].mode = mode;
+	g_config.filter[channel].shift = shift;
+	s_state[channel].primed = 0;
+	s_channel = channel;
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static int32_t median3(int32_t a, int32_t b, int32_t c)
+{
+	if (a > b) {
+		int32_t t = a;
+		a = b;
+		b = t;
+	}
+	// a <= b, the median is b unless c is below it
+	if (c < b)
+		b = (c > a) ? c : a;
+	return b;
+}
+
+void filter_sample(uint8_t channel, int32_t x)
+{
+	struct filter_state* s = &s_state[channel];
+	uint8_t mode = g_config.filter[channel].mode;
+	uint8_t shift = g_config.filter[channel].shift;
+
+	// the first sample fills everything, no start up transient
+	if (!s->primed) {
+		s->hist[0] = x;
+		s->hist[1] = x;
+		s->stage[0] = x << FILTER_FRAC;
+		s->stage[1] = x << FILTER_FRAC;
+		s->out = x;
+		s->count = 0;
+		if ((mode & ~FILTER_MEDIAN) == FILTER_AVERAGE)
+			s->stage[0] = 0;
+		s->primed = 1;
+	}
+
+	if (mode & FILTER_MEDIAN) {
+		int32_t m = median3(x, s->hist[0], s->hist[1]);
+		s->hist[1] = s->hist[0];
+		s->hist[0] = x;
+		x = m;
+	}
+
+	switch (mode & ~FILTER_MEDIAN) {
+	case FILTER_LOWPASS2:
+		s->stage[0] += ((x << FILTER_FRAC) - s->stage[0]) >> shift;
+		s->stage[1] += (s->stage[0] - s->stage[1]) >> shift;
+		s->out = s->stage[1] >> FILTER_FRAC;
+		break;
+	case FILTER_LOWPASS1:
+		s->stage[0] += ((x << FILTER_FRAC) - s->stage[0]) >> shift;
+		s->out = s->stage[0] >> FILTER_FRAC;
+		break;
+	case FILTER_AVERAGE:
+		s->stage[0] += x;
+		if (++s->count == (1 << shift)) {
+			s->out = s->stage[0] >> shift;
+			s->stage[0] = 0;
+			s->count = 0;
+		}
+		break;
+	default:
+		s->out = x;
+		break;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+int32_t filter_output(uint8_t channel)
+{
+	return s_state[channel].out;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void filter_mcs_data(can_msg_t* msg)
+{
+	msg->data[4] = s_channel;
+	msg->data[5] = g_config.filter[s_channel].mode;
+	msg->data[6] = g_config.filter[s_channel].shift;
+	msg->data[7] = 0;
+}
@@ -0,0 +1,83 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * per channel filters in front of the NOD encoders, integer only
+ *
+ * every channel has an optional median of 3 spike rejection followed
+ * by one of
+ *   FILTER_NONE      the sample as is
+ *   FILTER_LOWPASS1  first order IIR, y += (x - y) / 2^shift
+ *   FILTER_LOWPASS2  two of them in series, second order
+ *   FILTER_AVERAGE   block average of 2^shift samples, the output
+ *                    changes once per block, so it also decimates
+ * the -3 dB point of a low pass stage is about
+ *   sample rate / (2 pi 2^shift)
+ * accel and rate channels are sampled at 80 hz, pressures at 10 hz.
+ *
+ * the samples are the calibrated accel and rate counts, and the bmp085
+ * pressures. Only the messages see the filters, the attitude estimator,
+ * air data and telemetry take the samples as they come.
+ *
+ * MCS code FILTER_MCS_SET takes UCHAR4 channel, mode, shift, 0 and
+ * replies with the setting, the settings are kept in the config. All
+ * channels start as FILTER_NONE. State is 22 bytes per channel.
+ */
+
+// channels
+enum filter_channel {
+	FILTER_LONG_ACCEL,
+	FILTER_LAT_ACCEL,
+	FILTER_NORM_ACCEL,
+	FILTER_PITCH_RATE,
+	FILTER_ROLL_RATE,
+	FILTER_YAW_RATE,
+	FILTER_STATIC_PRESS,
+	FILTER_TOTAL_PRESS,
+	FILTER_NUM_CHANNELS
+};
+
+// filter kinds, in the low bits of the mode
+enum filter_kind {
+	FILTER_NONE,
+	FILTER_LOWPASS1,
+	FILTER_LOWPASS2,
+	FILTER_AVERAGE,
+	FILTER_NUM_KINDS
+};
+
+// mode flag, median of 3 before the filter
+#define FILTER_MEDIAN           0x80
+
+// largest shift, 128 samples
+#define FILTER_MAX_SHIFT        7
+
+// service codes
+#define FILTER_MCS_SET          18
+
+// setting of a channel, kept in the config
+struct filter_setting {
+	uint8_t mode;           // filter_kind | FILTER_MEDIAN
+	uint8_t shift;          // 1 .. FILTER_MAX_SHIFT, 0 for FILTER_NONE
+};
+
+// start all channels over, a bad setting in the config is FILTER_NONE
+extern void filter_init(void);
+
+// set a channel and start it over, returns 1 if the setting is invalid
+extern uint8_t filter_set(uint8_t channel, uint8_t mode, uint8_t shift);
+
+// run a new sample of a channel through its filter
+extern void filter_sample(uint8_t channel, int32_t x);
+
+// last output of a channel
+extern int32_t filter_output(uint8_t channel);
+
+// MCS data, UCHAR4 channel, mode, shift of the channel last set
+extern void filter_mcs_data(can_msg_t* msg);
+
+#endif  // FILTER_H_
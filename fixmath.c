@@ -0,0 +1,254 @@
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+
+#include "fixmath.h"
+
+/*-----------------------------------------------------------------------*/
+
+// number of cordic iterations, error is ~0.004 degrees
+#define CORDIC_ITERATIONS 16
+
+// atan(2^-i) as bam32
+static const int32_t k_cordic_atan[CORDIC_ITERATIONS] PROGMEM = {
+	536870912L, 316933406L, 167458907L, 85004756L,
+	42667331L, 21354465L, 10679838L, 5340245L,
+	2670163L, 1335087L, 667544L, 333772L,
+	166886L, 83443L, 41722L, 20861L,
+};
+
+// first quadrant of sine in Q15, 64 steps plus the end point
+static const int16_t k_sin_table[65] PROGMEM = {
+	0, 804, 1608, 2411, 3212, 4011, 4808, 5602,
+	6393, 7180, 7962, 8740, 9512, 10279, 11039, 11793,
+	12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+	18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+	23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+	27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+	30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+	32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+	32767,
+};
+
+// 1 / sqrt(m) in Q15 for m = 1 .. 4 in steps of 1/8
+static const uint16_t k_rsqrt_table[25] PROGMEM = {
+	32768, 30894, 29309, 27945, 26755, 25705, 24770, 23930,
+	23170, 22479, 21845, 21263, 20724, 20225, 19760, 19326,
+	18919, 18536, 18176, 17837, 17515, 17211, 16921, 16646,
+	16384,
+};
+
+// log2(1 + i / 64) in Q16, the end point 65536 is implied
+static const uint16_t k_log2_table[64] PROGMEM = {
+	0, 1466, 2909, 4331, 5732, 7112, 8473, 9814,
+	11136, 12440, 13727, 14996, 16248, 17484, 18704, 19909,
+	21098, 22272, 23433, 24579, 25711, 26830, 27936, 29029,
+	30109, 31178, 32234, 33279, 34312, 35334, 36346, 37346,
+	38336, 39316, 40286, 41246, 42196, 43137, 44068, 44990,
+	45904, 46809, 47705, 48593, 49472, 50344, 51207, 52063,
+	52911, 53751, 54584, 55410, 56229, 57040, 57845, 58643,
+	59434, 60219, 60997, 61769, 62534, 63294, 64047, 64794,
+};
+
+// 2^(i / 64) - 1 in Q16, the end point 65536 is implied
+static const uint16_t k_exp2_table[64] PROGMEM = {
+	0, 714, 1435, 2164, 2902, 3647, 4400, 5162,
+	5932, 6710, 7496, 8292, 9096, 9908, 10730, 11560,
+	12400, 13249, 14106, 14974, 15850, 16737, 17633, 18538,
+	19454, 20379, 21315, 22260, 23216, 24183, 25160, 26148,
+	27146, 28155, 29175, 30207, 31249, 32303, 33369, 34446,
+	35534, 36635, 37747, 38872, 40009, 41158, 42320, 43495,
+	44682, 45882, 47095, 48322, 49562, 50815, 52082, 53363,
+	54658, 55966, 57289, 58627, 59979, 61346, 62727, 64124,
+};
+
+/*-----------------------------------------------------------------------*/
+
+// cordic in vectoring mode, rotate (x,y) onto the x axis and
+// accumulate the angle needed to get there
+int32_t fix_atan2(int32_t y, int32_t x)
+{
+	// accumulate unsigned, so the wrap at 180 degrees is defined
+	uint32_t angle = 0;
+
+	if (x == 0 && y == 0)
+		return 0;
+
+	// move into the right half plane, cordic converges within +-99 degrees
+	if (x < 0) {
+		x = -x;
+		y = -y;
+		angle = 0x80000000UL;
+	}
+
+	// scale so the gain of 1.65 can't overflow, and small inputs
+	// keep enough bits for the last iterations
+	int32_t m = (y < 0) ? -y : y;
+	if (x > m)
+		m = x;
+	while (m >= 0x10000000L) {
+		x >>= 1;
+		y >>= 1;
+		m >>= 1;
+	}
+	while (m < 0x08000000L) {
+		x <<= 1;
+		y <<= 1;
+		m <<= 1;
+	}
+
+	for (uint8_t i=0; i<CORDIC_ITERATIONS; ++i) {
+		int32_t dx = x >> i;
+		int32_t dy = y >> i;
+		uint32_t da = pgm_read_dword(&k_cordic_atan[i]);
+		if (y > 0) {
+			x += dy;
+			y -= dx;
+			angle += da;
+		} else {
+			x -= dy;
+			y += dx;
+			angle -= da;
+		}
+	}
+	return (int32_t)angle;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// table lookup with linear interpolation, error is < 6 lsb (2e-4)
+static int16_t sin_quadrant(uint16_t a)
+{
+	// a is 0..0x3fff, 6 bit index, 8 bit fraction
+	uint8_t idx = a >> 8;
+	uint8_t frac = a & 0xff;
+	int16_t s0 = pgm_read_word(&k_sin_table[idx]);
+	int16_t s1 = pgm_read_word(&k_sin_table[idx + 1]);
+	return s0 + (int16_t)(((int32_t)(s1 - s0) * frac) >> 8);
+}
+
+void fix_sincos(uint16_t angle, int16_t* s, int16_t* c)
+{
+	uint16_t a = angle & 0x3fff;
+	int16_t sa = sin_quadrant(a);
+	int16_t ca = sin_quadrant(0x4000 - a - 1);
+
+	switch (angle >> 14) {
+	case 0:
+		*s = sa;
+		*c = ca;
+		break;
+	case 1:
+		*s = ca;
+		*c = -sa;
+		break;
+	case 2:
+		*s = -sa;
+		*c = -ca;
+		break;
+	default:
+		*s = -ca;
+		*c = sa;
+		break;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t fix_isqrt32(uint32_t v)
+{
+	uint32_t res = 0;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > v)
+		bit >>= 2;
+	while (bit) {
+		if (v >= res + bit) {
+			v -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint16_t)res;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint32_t fix_rsqrt32(uint32_t v)
+{
+	if (v == 0)
+		return UINT32_MAX;
+
+	// even shift into 2^30 .. 2^32, 1/sqrt(v) = 2^k / sqrt(v << 2k)
+	uint8_t k = 0;
+	while (v < 0x00400000UL) {
+		v <<= 8;
+		k += 4;
+	}
+	while (v < 0x40000000UL) {
+		v <<= 2;
+		++k;
+	}
+
+	// first guess from the table, m = v / 2^30, 3 bit index, 8 bit fraction
+	uint8_t idx = (v >> 27) - 8;
+	uint8_t frac = v >> 19;
+	uint16_t y0 = pgm_read_word(&k_rsqrt_table[idx]);
+	uint16_t y1 = pgm_read_word(&k_rsqrt_table[idx + 1]);
+	uint32_t y = y0 - (((uint32_t)(y0 - y1) * frac) >> 8);
+
+	// one newton step y (3 - m y^2) / 2, m y^2 in Q30, the result Q16.
+	// y^2 keeps 14 to 16 bits, v the other way round, as m y^2 ~ 1
+	uint32_t my2 = ((y * y) >> 14) * (v >> 16);
+	y = (y * (((3UL << 30) - my2) >> 15)) >> 15;
+	return y << k;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// table lookup with linear interpolation, 6 bit index, 10 bit fraction
+static uint16_t interp64(const uint16_t* table, uint16_t x)
+{
+	uint8_t idx = x >> 10;
+	uint16_t frac = x & 0x3ff;
+	uint16_t t0 = pgm_read_word(&table[idx]);
+	uint32_t t1 = (idx == 63) ? 65536UL : pgm_read_word(&table[idx + 1]);
+	return t0 + (uint16_t)(((t1 - t0) * frac) >> 10);
+}
+
+int32_t fix_log2(uint32_t v)
+{
+	if (v == 0)
+		return INT32_MIN;
+
+	// integer part is the msb, the rest is the mantissa 1.0 .. 2.0
+	int8_t n = 31;
+	while (!(v & 0xff000000UL)) {
+		v <<= 8;
+		n -= 8;
+	}
+	while (!(v & 0x80000000UL)) {
+		v <<= 1;
+		--n;
+	}
+	return ((int32_t)n << 16) + interp64(k_log2_table, (uint16_t)(v >> 15));
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint32_t fix_exp2(int32_t x)
+{
+	int16_t n = x >> 16;
+
+	if (n >= 16)
+		return UINT32_MAX;
+	if (n < -17)
+		return 0;
+
+	// 2^fraction in Q16 is 1.0 .. 2.0, then the integer part is a shift
+	uint32_t m = 65536UL + interp64(k_exp2_table, (uint16_t)x);
+	if (n >= 0)
+		return m << n;
+	return (m + (1UL << (-n - 1))) >> -n;
+}
@@ -0,0 +1,49 @@
+#ifndef FIXMATH_H_
+#define FIXMATH_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * integer math kernels, no floating point
+ *
+ * angles are binary angles (BAM), the full circle is the full range
+ * of the integer type, so they wrap for free:
+ *   bam32: 1 lsb = 360 / 2^32 degrees
+ *   bam16: 1 lsb = 360 / 2^16 degrees
+ * sin/cos results are Q15 (32767 = 1.0)
+ *
+ * all tables are in flash, worst case errors over the whole input
+ * range, against double precision:
+ *   fix_atan2    0.004 degrees
+ *   fix_sincos   6 lsb Q15 (2e-4)
+ *   fix_isqrt32  exact
+ *   fix_rsqrt32  4.5e-5 relative, table and one newton step
+ *   fix_log2     6 lsb Q16 (1e-4)
+ *   fix_exp2     2.1e-5 relative, 2 lsb Q16 below 1.0
+ * host/fixmathcheck.c holds them to these bounds, cycle counts are the
+ * fix_* lines of "make bench"
+ */
+
+// Q15 value of 1.0, saturated
+#define FIX_Q15_ONE     32767
+
+// atan2 of y/x as a bam32, x,y need not be normalized
+extern int32_t fix_atan2(int32_t y, int32_t x);
+
+// sine and cosine of a bam16 angle in Q15
+extern void fix_sincos(uint16_t angle, int16_t* s, int16_t* c);
+
+// integer square root, floor(sqrt(v))
+extern uint16_t fix_isqrt32(uint32_t v);
+
+// inverse square root, 2^31 / sqrt(v), UINT32_MAX for 0
+extern uint32_t fix_rsqrt32(uint32_t v);
+
+// log2(v) in Q16, INT32_MIN for 0. For a Q16 input take off 16 << 16
+extern int32_t fix_log2(uint32_t v);
+
+// 2^(x / 65536) in Q16, saturates at UINT32_MAX from x = 16.0
+extern uint32_t fix_exp2(int32_t x);
+
+#endif  // FIXMATH_H_
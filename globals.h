@@ -5,6 +5,7 @@
 #include "canaero.h"
 #include "bmp085.h"
 #include "l3g4200d.h"
+#include "adxl345.h"
 
 // global state enumeration
 enum ahrs_state {AHRSINIT, AHRSLISTEN, AHRSACTIVE};
@@ -27,6 +28,9 @@ extern struct bmp085_dev_t g_bmp085_data[2];
 // l3g4200d device structure
 extern l3g4200d_dev_t g_gyro_dev;
 
+// adxl345 axis and sign maps
+extern struct adxl345_device g_adxl345_dev;
+
 // the cycle time (approx 80hz) in tenth milliseconds
 extern uint32_t g_cycle_time;
 
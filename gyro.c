@@ -0,0 +1,228 @@
+#include <inttypes.h>
+#include <util/atomic.h>
+
+#include "gyro.h"
+#include "globals.h"
+#include "hal.h"
+
+/*-----------------------------------------------------------------------*/
+
+#define GYRO_RING_MASK (GYRO_RING_SIZE - 1)
+
+// samples written by the isr at head, read by the task at tail
+static int16_t s_ring[GYRO_RING_SIZE][3];
+static volatile uint8_t s_head;
+static volatile uint8_t s_tail;
+static volatile uint16_t s_overruns;
+
+// the averaged rates
+static int16_t s_rate[3];
+
+#ifdef GYRO_FIFO
+
+// l3g4200d registers
+#define L3G_CTRL_REG3       0x22
+#define L3G_CTRL_REG5       0x24
+#define L3G_OUT_X_L         0x28
+#define L3G_FIFO_CTRL_REG   0x2E
+#define L3G_FIFO_SRC_REG    0x2F
+
+// spi address bits, read and address auto increment
+#define L3G_READ            0x80
+#define L3G_MULTI           0x40
+
+#define L3G_I2_WTM          0x04    // CTRL_REG3, watermark on DRDY/INT2
+#define L3G_FIFO_EN         0x40    // CTRL_REG5
+#define L3G_FIFO_BYPASS     0x00    // FIFO_CTRL_REG mode
+#define L3G_FIFO_STREAM     0x40
+#define L3G_FIFO_OVRN       0x40    // FIFO_SRC_REG
+#define L3G_FIFO_EMPTY      0x20
+#define L3G_FIFO_FSS        0x1F
+#define L3G_FIFO_SIZE       32
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t gyro_read_reg(uint8_t reg)
+{
+	hal_gyro_select();
+	hal_spi_transfer(reg | L3G_READ);
+	uint8_t v = hal_spi_transfer(0);
+	hal_gyro_deselect();
+	return v;
+}
+
+static void gyro_write_reg(uint8_t reg, uint8_t v)
+{
+	hal_gyro_select();
+	hal_spi_transfer(reg);
+	hal_spi_transfer(v);
+	hal_gyro_deselect();
+}
+
+/*-----------------------------------------------------------------------*/
+
+// move up to 'max' samples of the FIFO into the ring, no more than
+// it has room for, the rest stays in the FIFO. Called with INT6 off
+static void gyro_capture(uint8_t max)
+{
+	uint8_t src = gyro_read_reg(L3G_FIFO_SRC_REG);
+	if (src & L3G_FIFO_EMPTY)
+		return;
+	// FSS doesn't go to 32, a full FIFO reads 0
+	uint8_t n = src & L3G_FIFO_FSS;
+	if (n == 0)
+		n = L3G_FIFO_SIZE;
+	if (src & L3G_FIFO_OVRN) {
+		// the oldest were overwritten
+		n = L3G_FIFO_SIZE;
+		++s_overruns;
+	}
+	uint8_t room = GYRO_RING_MASK - ((s_head - s_tail) & GYRO_RING_MASK);
+	if (n > max)
+		n = max;
+	if (n > room)
+		n = room;
+	if (n == 0)
+		return;
+
+	// in FIFO mode the address rolls back from OUT_Z_H to OUT_X_L,
+	// so one burst reads every sample, little endian
+	hal_gyro_select();
+	hal_spi_transfer(L3G_OUT_X_L | L3G_READ | L3G_MULTI);
+	while (n--) {
+		int16_t v[3];
+		for (uint8_t i=0; i<3; ++i) {
+			uint8_t lo = hal_spi_transfer(0);
+			v[i] = (int16_t)(((uint16_t)hal_spi_transfer(0) << 8) | lo);
+		}
+		uint8_t h = s_head;
+		for (uint8_t i=0; i<3; ++i)
+			s_ring[h][i] = v[i] * g_gyro_dev.sensor_sign[i];
+		s_head = (h + 1) & GYRO_RING_MASK;
+	}
+	hal_gyro_deselect();
+}
+
+#else
+
+// read one sample into the ring, called with INT6 off
+static void gyro_capture(void)
+{
+	l3g4200d_read_data(&g_gyro_dev);
+
+	uint8_t h = s_head;
+	uint8_t next = (h + 1) & GYRO_RING_MASK;
+	if (next == s_tail) {
+		// full, drop the sample, it still has to be read to clear DRDY
+		++s_overruns;
+		return;
+	}
+	for (uint8_t i=0; i<3; ++i)
+		s_ring[h][i] = l3g4200d_raw_data(&g_gyro_dev, i);
+	s_head = next;
+}
+
+#endif  // GYRO_FIFO
+
+/*-----------------------------------------------------------------------*/
+
+ISR(INT6_vect)
+{
+	if (!g_gyros_enabled)
+		return;
+#ifdef GYRO_FIFO
+	// a watermark's worth with the i-bit clear, gyro_update() takes
+	// the rest with the other interrupts on
+	gyro_capture(GYRO_FIFO_WTM);
+#else
+	gyro_capture();
+#endif
+}
+
+/*-----------------------------------------------------------------------*/
+
+void gyro_init(void)
+{
+	s_head = 0;
+	s_tail = 0;
+	s_overruns = 0;
+
+#ifdef GYRO_FIFO
+	// bypass empties the FIFO, then stream mode with the watermark
+	// on DRDY/INT2 in place of data ready
+	gyro_write_reg(L3G_FIFO_CTRL_REG, L3G_FIFO_BYPASS);
+	gyro_write_reg(L3G_CTRL_REG5, gyro_read_reg(L3G_CTRL_REG5) | L3G_FIFO_EN);
+	gyro_write_reg(L3G_CTRL_REG3, L3G_I2_WTM);
+	gyro_write_reg(L3G_FIFO_CTRL_REG, L3G_FIFO_STREAM | GYRO_FIFO_WTM);
+#endif
+
+	// INT6 on the rising edge of DRDY
+	hal_extint_rising(P_GYRODRDY);
+	hal_extint_arm(P_GYRODRDY);
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t gyro_update(void)
+{
+#ifdef GYRO_FIFO
+	// take what came in since the last watermark, this also brings the
+	// line below the watermark again if its edge was missed. Only INT6
+	// is held off, a full FIFO is a 193 byte burst and the uart, CAN
+	// and timer interrupts can't wait that long
+	hal_extint_disable(P_GYRODRDY);
+	gyro_capture(GYRO_RING_SIZE);
+	hal_extint_arm(P_GYRODRDY);
+#endif
+	uint8_t head = s_head;
+	uint8_t tail = s_tail;
+	uint8_t avail = (head - tail) & GYRO_RING_MASK;
+
+	if (avail == 0) {
+#ifndef GYRO_FIFO
+		// DRDY is level, if the edge was missed it stays high and
+		// no more interrupts come, read it here to rearm
+		if (hal_gyro_drdy()) {
+			hal_extint_disable(P_GYRODRDY);
+			gyro_capture();
+			hal_extint_arm(P_GYRODRDY);
+		}
+#endif
+		return 0;
+	}
+
+	// average every sample since the last frame, 5 at 400hz, the
+	// divides are ~700 cycles an axis at 80hz
+	int32_t sum[3] = {0, 0, 0};
+	uint8_t idx = tail;
+	for (uint8_t k=0; k<avail; ++k) {
+		for (uint8_t i=0; i<3; ++i)
+			sum[i] += s_ring[idx][i];
+		idx = (idx + 1) & GYRO_RING_MASK;
+	}
+	for (uint8_t i=0; i<3; ++i)
+		s_rate[i] = (int16_t)(sum[i] / avail);
+
+	// release the slots to the isr
+	s_tail = head;
+	return avail;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int16_t gyro_rate(uint8_t axis)
+{
+	return s_rate[axis];
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t gyro_overruns(void)
+{
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		n = s_overruns;
+	}
+	return n;
+}
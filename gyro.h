@@ -0,0 +1,49 @@
+#ifndef GYRO_H_
+#define GYRO_H_
+
+#include <inttypes.h>
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * interrupt driven gyro acquisition
+ *
+ * every DRDY rising edge (INT6) reads a sample into a ring buffer, the
+ * 80hz task averages all samples that came in since the last frame,
+ * 5 at the l3g4200d output data rate of 400hz.
+ *
+ * with GYRO_FIFO (SENSOR_FIFO and a known chip select) the l3g4200d
+ * keeps its samples in its 32 deep FIFO in stream mode and raises the
+ * DRDY/INT2 line at GYRO_FIFO_WTM samples instead of at every sample.
+ * INT6 then moves GYRO_FIFO_WTM samples into the ring in one spi
+ * burst, and gyro_update() the rest, so the average has all of them.
+ * A burst never takes more than the ring has room for, the rest stays
+ * in the FIFO for the next frame. One interrupt and one chip select
+ * per GYRO_FIFO_WTM samples instead of per sample.
+ */
+
+// the FIFO bursts need the chip select, see defs.h
+#if defined(SENSOR_FIFO) && defined(P_GYROCS)
+#define GYRO_FIFO
+#endif
+
+// ring buffer size, must be a power of 2
+#define GYRO_RING_SIZE    16
+
+// l3g4200d FIFO watermark, one 80hz frame at 400hz
+#define GYRO_FIFO_WTM     5
+
+// setup the DRDY interrupt, and the FIFO with GYRO_FIFO
+extern void gyro_init(void);
+
+// consume the ring buffer into the current rates
+// returns the number of samples averaged, 0 if the rates are stale
+extern uint8_t gyro_update(void);
+
+// current rate in raw counts, pitch, roll, yaw
+extern int16_t gyro_rate(uint8_t axis);
+
+// number of samples dropped because the ring buffer was full
+extern uint16_t gyro_overruns(void);
+
+#endif  // GYRO_H_
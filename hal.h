@@ -0,0 +1,49 @@
+#ifndef HAL_H_
+#define HAL_H_
+
+/*-----------------------------------------------------------------------*/
+/*
+ * hardware abstraction
+ *
+ * the registers the application touches itself are only used through
+ * the names below, the drivers in ../libs have their own interfaces
+ * (uart.h, i2cmaster.h, spi.h, timer.h, timer1.h, at90can.h).
+ *
+ * hal_avr.h is the target backend, inline register accesses, so it
+ * costs nothing over writing them out. host/ has a backend with the
+ * same names plus the driver interfaces, that builds the firmware as
+ * a linux process (see host/README.md).
+ *
+ *   hal_clock_init()           system clock prescaler
+ *   hal_console_init()         stdin, stdout on the uart
+ *   hal_irq_enable()           global interrupt enable
+ *   hal_led_on(n), _off(n)     led 1 or 2
+ *   hal_baro_enable(mask)      XCLR of the bmp085s, bit 0 static,
+ *                              bit 1 total, a 0 holds it in reset
+ *   hal_gyro_drdy()            level of the l3g4200d DRDY line
+ *   hal_gyro_select()          l3g4200d chip select low
+ *   hal_gyro_deselect()        and high again
+ *   hal_spi_transfer(b)        send a byte on spi, returns the byte read
+ *   hal_extint_rising(pin)     external interrupt of a port E pin
+ *   hal_extint_arm(pin)        clear and enable it
+ *   hal_extint_disable(pin)
+ *   hal_timer1_count()         timer1 count in the scheduler tick
+ *   hal_timer1_match()         tick compare match not serviced yet
+ *   hal_uart_tx_idle()         console uart has nothing queued
+ *   hal_ram_start()            start of the static data
+ *   hal_heap_start()           end of the bss
+ *   hal_ram_end()              last byte of ram
+ *   hal_stack_pointer()
+ *   hal_busy(us)               background work of about 'us' is done,
+ *                              the host moves its virtual time on
+ *
+ * interrupt handlers are written ISR(INTn_vect) as usual
+ */
+
+#ifdef __AVR__
+#include "hal_avr.h"
+#else
+#include "hal_host.h"
+#endif
+
+#endif  // HAL_H_
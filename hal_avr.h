@@ -0,0 +1,125 @@
+#ifndef HAL_AVR_H_
+#define HAL_AVR_H_
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "defs.h"
+#include "uart.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * at90can32 backend of hal.h
+ */
+
+// linker symbols, start of the static data and end of the bss
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+
+/*-----------------------------------------------------------------------*/
+
+static inline void hal_clock_init(void)
+{
+	// first set the clock prescaler change enable
+	CLKPR = _BV(CLKPCE);
+	// now set the clock prescaler to clk / 2
+	CLKPR = _BV(CLKPS0);
+}
+
+static inline void hal_console_init(void)
+{
+	static FILE ostr = FDEV_SETUP_STREAM(uart_putchar, NULL, _FDEV_SETUP_WRITE);
+	static FILE istr = FDEV_SETUP_STREAM(NULL, uart_getchar, _FDEV_SETUP_READ);
+
+	stdout = &ostr;
+	stdin = &istr;
+}
+
+#define hal_irq_enable()        sei()
+
+#define hal_led_on(n)           (PORT_LED##n |= _BV(P_LED##n))
+#define hal_led_off(n)          (PORT_LED##n &= ~_BV(P_LED##n))
+
+/*-----------------------------------------------------------------------*/
+
+static inline void hal_baro_enable(uint8_t mask)
+{
+	if (mask & 1)
+		PORT_XCLR1 |= _BV(P_XCLR1);
+	else
+		PORT_XCLR1 &= ~(_BV(P_XCLR1));
+	if (mask & 2)
+		PORT_XCLR2 |= _BV(P_XCLR2);
+	else
+		PORT_XCLR2 &= ~(_BV(P_XCLR2));
+}
+
+#define hal_gyro_drdy()         bit_is_set(PIN_GYRODRDY, P_GYRODRDY)
+
+#ifdef BENCH
+
+// simulavr has nothing on the spi bus, bench/stubs.c answers as the gyro
+extern void bench_spi_select(void);
+extern uint8_t bench_spi_transfer(uint8_t b);
+
+#define hal_gyro_select()       bench_spi_select()
+#define hal_gyro_deselect()     ((void)0)
+#define hal_spi_transfer(b)     bench_spi_transfer(b)
+
+#else
+
+#define hal_gyro_select()       (PORT_GYROCS &= ~_BV(P_GYROCS))
+#define hal_gyro_deselect()     (PORT_GYROCS |= _BV(P_GYROCS))
+
+// spi is set up by spi_init(), master, polled
+static inline uint8_t hal_spi_transfer(uint8_t b)
+{
+	SPDR = b;
+	loop_until_bit_is_set(SPSR, SPIF);
+	return SPDR;
+}
+
+#endif  // BENCH
+
+/*-----------------------------------------------------------------------*/
+
+// INT4..INT7 are on PE4..PE7, the pin number is the interrupt number
+
+static inline void hal_extint_rising(uint8_t pin)
+{
+	EICRB |= (_BV(ISC40) | _BV(ISC41)) << ((pin - 4) * 2);
+}
+
+static inline void hal_extint_arm(uint8_t pin)
+{
+	EIFR = _BV(pin);
+	EIMSK |= _BV(pin);
+}
+
+static inline void hal_extint_disable(uint8_t pin)
+{
+	EIMSK &= ~_BV(pin);
+}
+
+/*-----------------------------------------------------------------------*/
+
+#define hal_timer1_count()      TCNT1
+#define hal_timer1_match()      bit_is_set(TIFR1, OCF1A)
+
+// the uart driver isn't sending and the data register is free
+#define hal_uart_tx_idle()      (bit_is_clear(UCSR1B, UDRIE1) \
+								 && bit_is_set(UCSR1A, UDRE1))
+
+/*-----------------------------------------------------------------------*/
+
+#define hal_ram_start()         (&__data_start)
+#define hal_heap_start()        (&__heap_start)
+#define hal_ram_end()           ((uint8_t*)RAMEND)
+#define hal_stack_pointer()     ((uint8_t*)(uintptr_t)SP)
+
+// the time was really spent
+#define hal_busy(us)            ((void)0)
+
+#endif  // HAL_AVR_H_
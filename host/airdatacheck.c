@@ -0,0 +1,181 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "airdata.h"
+#include "baro.h"
+#include "config.h"
+#include "globals.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * airdata.c against the ISA
+ *
+ *   ./build-host/airdata_check
+ *
+ * pressure altitude over the whole table and at the standard
+ * atmosphere points, indicated airspeed over the whole qc range, and
+ * the QNH corrected altitude through airdata_update() for a spread of
+ * QNH settings. Prints the worst errors and fails if one is over the
+ * bounds in airdata.h.
+ */
+
+// the bounds of airdata.h, m down to a pressure in Pa
+static const struct {
+	int32_t press;
+	double m;
+} k_alt_bound[] = {
+	{80000, 0.14},
+	{54000, 0.27},
+	{0, 1.3},
+};
+
+// cm/s, and m on top of the altitude bound with a QNH
+#define IAS_BOUND_CMS       3.0
+#define QNH_BOUND_M         0.1
+
+// table range, airdata.c
+#define ALT_PRESS_LO        22528L
+#define ALT_PRESS_HI        110591L
+
+// ISA altitude in m and pressure in Pa, from the standard tables
+static const struct {
+	double m;
+	double press;
+} k_isa[] = {
+	{-500, 107477.7}, {0, 101325.0}, {1000, 89874.6}, {2000, 79495.2},
+	{3000, 70108.5}, {4000, 61640.2}, {5000, 54019.9}, {6000, 47181.0},
+	{8000, 35599.8}, {10000, 26436.3}, {11000, 22632.1},
+};
+
+struct bmp085_dev_t g_bmp085_data[2];
+int g_static_air_enabled = 1;
+int g_dynamic_air_enabled = 1;
+struct config g_config;
+
+static int s_failed;
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t baro_fresh(uint8_t device)
+{
+	return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// ISA troposphere, m
+static double isa_altitude(double press)
+{
+	return 44330.77 * (1 - pow(press / 101325.0, 0.190263));
+}
+
+// subsonic compressible airspeed of the sea level ISA, m/s
+static double isa_ias(double qc)
+{
+	return 340.294 * sqrt(5 * (pow(qc / 101325.0 + 1, 2 / 7.0) - 1));
+}
+
+// documented altitude bound at a pressure, m
+static double alt_bound(double press)
+{
+	uint8_t i = 0;
+	while (press < k_alt_bound[i].press)
+		++i;
+	return k_alt_bound[i].m;
+}
+
+static void report(const char* name, double worst, double bound,
+				   const char* unit)
+{
+	int bad = worst > bound;
+	printf("%-18s worst %.3f %s, bound %.2f%s\n", name, worst, unit, bound,
+		   bad ? "  FAILED" : "");
+	s_failed |= bad;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// worst error over the table, as a part of the bound at each pressure
+static void check_altitude(void)
+{
+	double worst[3] = {0, 0, 0};
+
+	for (int32_t p=ALT_PRESS_LO; p<=ALT_PRESS_HI; ++p) {
+		double e = fabs(airdata_pressure_altitude(p) / 100.0
+						- isa_altitude(p));
+		uint8_t i = 0;
+		while (p < k_alt_bound[i].press)
+			++i;
+		if (e > worst[i])
+			worst[i] = e;
+	}
+	report("altitude >800hPa", worst[0], k_alt_bound[0].m, "m");
+	report("altitude >540hPa", worst[1], k_alt_bound[1].m, "m");
+	report("altitude", worst[2], k_alt_bound[2].m, "m");
+
+	// the published points, the formula above is their source
+	double isa = 0;
+	for (uint8_t i=0; i<sizeof(k_isa) / sizeof(k_isa[0]); ++i) {
+		double h = airdata_pressure_altitude(lrint(k_isa[i].press)) / 100.0;
+		double e = fabs(h - k_isa[i].m) / alt_bound(k_isa[i].press);
+		if (e > isa)
+			isa = e;
+	}
+	report("isa points", isa, 1, "of the bound");
+}
+
+static void check_ias(void)
+{
+	double worst = 0;
+
+	for (int32_t qc=1; qc<=32767; ++qc) {
+		double e = fabs(airdata_ias(qc) - isa_ias(qc) * 100);
+		if (e > worst)
+			worst = e;
+	}
+	if (airdata_ias(0) != 0 || airdata_ias(-500) != 0)
+		worst = 1e9;
+	report("ias", worst, IAS_BOUND_CMS, "cm/s");
+}
+
+// the kollsman window, the table altitude of p * 101325 / QNH
+static void check_qnh(void)
+{
+	static const uint32_t k_qnh[] = {
+		AIRDATA_QNH_MIN, 95000, 99000, AIRDATA_QNH_STD, 102000, 104000,
+		AIRDATA_QNH_MAX,
+	};
+	double worst = 0;
+
+	for (uint8_t i=0; i<sizeof(k_qnh) / sizeof(k_qnh[0]); ++i) {
+		g_config.qnh = k_qnh[i];
+		airdata_init();
+		for (int32_t p=25000; p<=108000; p+=97) {
+			g_bmp085_data[0].press = p;
+			airdata_update();
+			double scaled = (double)p * AIRDATA_QNH_STD / k_qnh[i];
+			if (scaled > ALT_PRESS_HI)
+				continue;
+			double h = 44330.77 * (1 - pow(p / (double)k_qnh[i], 0.190263));
+			double e = fabs(airdata_baro_altitude() / 100.0 - h)
+				/ (alt_bound(scaled) + QNH_BOUND_M);
+			if (e > worst)
+				worst = e;
+		}
+	}
+	if (!airdata_set_qnh(AIRDATA_QNH_MIN - 1)
+		|| !airdata_set_qnh(AIRDATA_QNH_MAX + 1))
+		worst = 1e9;
+	report("qnh altitude", worst, 1, "of the bound");
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+	check_altitude();
+	check_ias();
+	check_qnh();
+	return s_failed;
+}
@@ -0,0 +1,97 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "calib.h"
+#include <avr/eeprom.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * calib.c with the coefficients of tools/calfit.py
+ *
+ *   python3 host/calibcheck.py ./build-host/calib_check
+ *
+ * loads the intel hex eeprom image named on the command line, then
+ * reads lines of
+ *   temp  gyro pitch roll yaw  accel long lat normal
+ * in 0.1 C and raw counts from stdin, and writes the corrected gyro
+ * and accel counts of calib_update() for each. calibcheck.py fits
+ * a known sensor model with calfit.py and checks what comes back.
+ * Exits 1 if the image doesn't load or calib_init() rejects it.
+ */
+
+static uint8_t s_eeprom[E2END + 1];
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+	return s_eeprom[(uintptr_t)addr];
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+	memcpy(dst, &s_eeprom[(uintptr_t)src], n);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t hex_byte(const char* s)
+{
+	unsigned v = 0;
+	sscanf(s, "%2x", &v);
+	return (uint8_t)v;
+}
+
+// data records of an intel hex file into the eeprom, 1 on an error
+static uint8_t load_hex(const char* path)
+{
+	FILE* f = fopen(path, "r");
+	char line[128];
+
+	if (!f)
+		return 1;
+	memset(s_eeprom, 0xff, sizeof(s_eeprom));
+	while (fgets(line, sizeof(line), f)) {
+		if (line[0] != ':' || strlen(line) < 11)
+			continue;
+		uint8_t len = hex_byte(line + 1);
+		uint16_t addr = (hex_byte(line + 3) << 8) | hex_byte(line + 5);
+		if (hex_byte(line + 7) != 0)
+			continue;
+		for (uint8_t i=0; i<len && addr + i <= E2END; ++i)
+			s_eeprom[addr + i] = hex_byte(line + 9 + i * 2);
+	}
+	fclose(f);
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+	int temp, g[3], a[3];
+
+	if (argc != 2 || load_hex(argv[1])) {
+		fprintf(stderr, "usage: calib_check calib.hex\n");
+		return 1;
+	}
+	if (calib_init()) {
+		fprintf(stderr, "calib_check: no valid coefficients\n");
+		return 1;
+	}
+
+	while (scanf("%d %d %d %d %d %d %d", &temp, &g[0], &g[1], &g[2],
+				 &a[0], &a[1], &a[2]) == 7) {
+		int16_t gyro[3], accel[3];
+		for (uint8_t i=0; i<3; ++i) {
+			gyro[i] = (int16_t)g[i];
+			accel[i] = (int16_t)a[i];
+		}
+		calib_update(gyro, accel, (int16_t)temp);
+		printf("%d %d %d %d %d %d\n", calib_gyro(0), calib_gyro(1),
+			   calib_gyro(2), calib_accel(0), calib_accel(1),
+			   calib_accel(2));
+	}
+	return 0;
+}
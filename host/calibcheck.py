@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# check tools/calfit.py and calib.c together, see calibcheck.c
+#
+# usage: calibcheck.py ./build-host/calib_check
+#
+# makes up a gyro and an accelerometer with a temperature dependent
+# bias, scale and misalignment, writes the csv files telemcap.py would
+# record on a rate table and in the six accel positions, fits them
+# with calfit.py and puts samples of the same sensors through
+# calib_update(). Exits 1 if a corrected sample is more than
+# CALIB_BOUND counts off the true one.
+#
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+CALIB_BOUND = 3
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TOOLS = os.path.join(HERE, '..', 'tools')
+
+# defs.h and calib.h
+GYRO_UDPS_PER_LSB = 8750
+ACCEL_LSB_PER_G = 256
+CALIB_TREF = 250
+
+# raw = K true + c0 + c1 dT + c2 dT^2, dT in 0.1 C from CALIB_TREF
+GYRO = {
+    'k': [[1.021, 0.006, -0.004], [-0.008, 0.987, 0.003],
+          [0.005, -0.002, 1.012]],
+    'bias': [[31.0, 0.052, 1.1e-4], [-12.0, -0.031, 0.6e-4],
+             [7.5, 0.018, -0.9e-4]],
+}
+ACCEL = {
+    'k': [[0.982, 0.011, -0.007], [0.004, 1.017, 0.009],
+          [-0.012, 0.006, 0.993]],
+    'bias': [[5.2, 0.021, 0.4e-4], [-3.1, -0.012, -0.3e-4],
+             [8.4, 0.009, 0.5e-4]],
+}
+
+CSV_HEAD = ('seq,time,pitch_rate,roll_rate,yaw_rate,long_accel,lat_accel,'
+            'norm_accel,static_pa,total_pa,temp_c')
+
+
+def raw(sensor, true, temp):
+    dt = temp - CALIB_TREF
+    out = []
+    for i in range(3):
+        c = sensor['bias'][i]
+        v = sum(sensor['k'][i][j] * true[j] for j in range(3))
+        out.append(round(v + c[0] + c[1] * dt + c[2] * dt * dt))
+    return out
+
+
+def write_csv(path, gyro, accel):
+    """a sweep of the board temperature, 0 to 45 C"""
+    with open(path, 'w') as f:
+        f.write(CSV_HEAD + '\n')
+        for n in range(451):
+            temp = n
+            g = raw(GYRO, gyro, temp)
+            a = raw(ACCEL, accel, temp)
+            f.write('%d,%.4f,%d,%d,%d,%d,%d,%d,101325,101400,%.1f\n' % (
+                n & 0xff, n * 0.0125, g[0], g[1], g[2], a[0], a[1], a[2],
+                temp / 10.0))
+
+
+def fit(tmp):
+    """the eeprom image calfit.py makes of the model"""
+    rate = 90 * 1e6 / GYRO_UDPS_PER_LSB
+    args = [sys.executable, os.path.join(TOOLS, 'calfit.py')]
+    write_csv(os.path.join(tmp, 'still.csv'), [0, 0, 0], [0, 0, 0])
+    args.append('--gyro=0=' + os.path.join(tmp, 'still.csv'))
+    for axis, name in enumerate('xyz'):
+        for sign in (1, -1):
+            s = '%s%s' % ('+' if sign > 0 else '-', name)
+            e = [0.0, 0.0, 0.0]
+            e[axis] = sign * rate
+            path = os.path.join(tmp, 'gyro%s.csv' % s)
+            write_csv(path, e, [0, 0, 0])
+            args.append('--gyro=%s:90=%s' % (s, path))
+            e = [0.0, 0.0, 0.0]
+            e[axis] = sign * ACCEL_LSB_PER_G
+            path = os.path.join(tmp, 'accel%s.csv' % s)
+            write_csv(path, [0, 0, 0], e)
+            args.append('--accel=%s=%s' % (s, path))
+    hexfile = os.path.join(tmp, 'calib.hex')
+    args += ['-o', hexfile]
+    subprocess.run(args, check=True, stdout=subprocess.DEVNULL)
+    return hexfile
+
+
+def main():
+    check = sys.argv[1]
+    rnd = random.Random(1)
+    with tempfile.TemporaryDirectory() as tmp:
+        hexfile = fit(tmp)
+
+        samples = []
+        for _ in range(5000):
+            temp = rnd.randint(0, 450)
+            g = [rnd.uniform(-20000, 20000) for _ in range(3)]
+            a = [rnd.uniform(-1000, 1000) for _ in range(3)]
+            samples.append((temp, g, a))
+        lines = ['%d %d %d %d %d %d %d' % ((t,) + tuple(raw(GYRO, g, t))
+                                           + tuple(raw(ACCEL, a, t)))
+                 for t, g, a in samples]
+        out = subprocess.run([check, hexfile], input='\n'.join(lines) + '\n',
+                             capture_output=True, text=True, check=True)
+
+    worst = [0.0, 0.0]
+    rows = out.stdout.split('\n')
+    if len(rows) - 1 != len(samples):
+        sys.exit('calibcheck: %d samples in, %d out' % (len(samples),
+                                                       len(rows) - 1))
+    for (t, g, a), row in zip(samples, rows):
+        v = [int(x) for x in row.split()]
+        worst[0] = max([worst[0]] + [abs(v[i] - g[i]) for i in range(3)])
+        worst[1] = max([worst[1]] + [abs(v[3 + i] - a[i]) for i in range(3)])
+    failed = False
+    for name, w in zip(('gyro', 'accel'), worst):
+        bad = w > CALIB_BOUND
+        print('%-6s worst %.2f counts, bound %d%s' % (
+            name, w, CALIB_BOUND, '  FAILED' if bad else ''))
+        failed |= bad
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
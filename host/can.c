@@ -0,0 +1,327 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include "host.h"
+#include "defs.h"
+#include "canaero.h"
+#include "canaero_filters.h"
+#include "canaero_ids.h"
+#include "canaero_nis.h"
+#include "canaero_bss.h"
+#include "at90can.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * CANaerospace stand-in
+ *
+ * just enough of the stack for the firmware's messages and services.
+ * With AHRS_CAN set to an interface (sudo ip link add vcan0 type vcan;
+ * sudo ip link set up vcan0) the frames go on that bus, candump and
+ * cansend talk to it. Without, frames are only counted.
+ * AHRS_CAN_LOG names a file every frame sent is written to, in the
+ * candump -L format on the virtual clock, canplayer and the other
+ * can-utils read it. AHRS_ACTIVE=1 sends the unit the MCS request
+ * that makes it active once it is up, as a replay needs.
+ *
+ * frames are the CANaerospace layout, data[0] node id, data[1] data
+ * type, data[2] service code, data[3] message code, then the payload.
+ * Service requests are taken on the node service channels, 128..199
+ * and 2000..2031 even ids, addressed to this node or to node 0, the
+ * reply goes out on the id above. IDS answers, NIS and BSS only
+ * acknowledge.
+ */
+
+#define SVC_HIGH_FIRST      128
+#define SVC_HIGH_END        200
+#define SVC_LOW_FIRST       2000
+#define SVC_LOW_END         2032
+#define SVC_NUM             16
+
+struct can_device at90can_dev = {0, -1};
+
+static uint8_t s_sequence[256];
+static FILE* s_log;
+static uint8_t s_activate;      // MCS state request pending
+static uint8_t s_activated;
+static const char* s_log_if;
+static uint32_t s_tx;
+static uint32_t s_rx;
+static uint32_t s_svc;
+
+/*-----------------------------------------------------------------------*/
+
+// payload bytes of a data type
+static uint8_t payload_size(canaero_data_type_t type)
+{
+	switch (type) {
+	case NODATA:
+		return 0;
+	case CHAR:
+	case UCHAR:
+	case BCHAR:
+		return 1;
+	case SHORT:
+	case USHORT:
+	case BSHORT:
+	case CHAR2:
+	case UCHAR2:
+	case BCHAR2:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+static int can_send(canaero_init_t* cfg, uint16_t id, canaero_data_type_t type,
+					uint8_t svc, uint8_t code, get_nod_msg_data_fn* fn)
+{
+	can_msg_t msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.id = id;
+	msg.data[0] = cfg->node_id;
+	msg.data[1] = type;
+	msg.data[2] = svc;
+	msg.data[3] = code;
+	if (fn)
+		fn(&msg);
+	msg.length = 4 + payload_size(type);
+
+	++s_tx;
+	if (s_log) {
+		uint64_t now = host_now();
+		static const char hex[] = "0123456789ABCDEF";
+		char data[2 * 8 + 1];
+		for (uint8_t i=0; i<msg.length; ++i) {
+			data[2 * i] = hex[msg.data[i] >> 4];
+			data[2 * i + 1] = hex[msg.data[i] & 15];
+		}
+		data[2 * msg.length] = 0;
+		fprintf(s_log, "(%" PRIu64 ".%06" PRIu64 ") %s %03X#%s\n",
+				now / 1000000, now % 1000000, s_log_if, msg.id, data);
+	}
+	if (cfg->can_dev->fd < 0)
+		return CAN_OK;
+
+	struct can_frame f;
+	memset(&f, 0, sizeof(f));
+	f.can_id = msg.id;
+	f.can_dlc = msg.length;
+	memcpy(f.data, msg.data, msg.length);
+	if (write(cfg->can_dev->fd, &f, sizeof(f)) != sizeof(f)) {
+		can_error_t err = {CAN_BUS_PASSIVE, 0, 0};
+		if (cfg->can_dev->handle_error_fn)
+			cfg->can_dev->handle_error_fn(cfg->can_dev, &err);
+		return CAN_FAILINIT;
+	}
+	return CAN_OK;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int canaero_init(canaero_init_t* cfg, struct can_device* dev)
+{
+	const char* name = host_env("AHRS_CAN", 0);
+	const char* log = host_env("AHRS_CAN_LOG", 0);
+
+	cfg->can_dev = dev;
+	if (!s_activated && atoi(host_env("AHRS_ACTIVE", "0"))) {
+		s_activated = 1;
+		s_activate = 1;
+	}
+	if (log && !s_log) {
+		s_log = fopen(log, "w");
+		if (!s_log) {
+			perror(log);
+			return CAN_FAILINIT;
+		}
+		setvbuf(s_log, 0, _IOFBF, 1 << 16);
+		s_log_if = name ? name : "can0";
+	}
+	if (!name || dev->fd >= 0)
+		return CAN_OK;
+
+	int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (fd < 0) {
+		perror("can socket");
+		return CAN_FAILINIT;
+	}
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+	struct sockaddr_can addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0
+		|| (addr.can_ifindex = ifr.ifr_ifindex,
+			bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0))
+	{
+		perror(name);
+		close(fd);
+		return CAN_FAILINIT;
+	}
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	dev->fd = fd;
+	return CAN_OK;
+}
+
+int canaero_self_test(canaero_init_t* cfg)
+{
+	return CAN_OK;
+}
+
+void canaero_high_priority_service_filters(canaero_init_t* cfg)
+{
+	cfg->can_settings.filters.filtering_on = 1;
+}
+
+void canaero_no_filters(canaero_init_t* cfg)
+{
+	cfg->can_settings.filters.filtering_on = 0;
+}
+
+void canaero_reset_nod_message_sequence(canaero_init_t* cfg)
+{
+	memset(s_sequence, 0, sizeof(s_sequence));
+}
+
+void can_clear_tx_buffers(struct can_device* dev)
+{
+}
+
+/*-----------------------------------------------------------------------*/
+
+int canaero_send_messages(canaero_init_t* cfg, int first, int end)
+{
+	int stat = CAN_OK;
+	for (int i=first; i<end; ++i) {
+		const canaero_msg_tmpl_t* t = &cfg->nod_msg_templates[i];
+		int s = can_send(cfg, t->message_id, t->data_type, t->service_code,
+						 s_sequence[i]++, t->fn);
+		if (s != CAN_OK)
+			stat = s;
+	}
+	return stat;
+}
+
+int canaero_send_svc_reply_message(canaero_init_t* cfg, service_msg_id_t* svc,
+								   canaero_svc_msg_tmpl_t* tmpl)
+{
+	return can_send(cfg, svc->request_id + 1, tmpl->data_type,
+					tmpl->service_code, tmpl->message_code, tmpl->fn);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int canaero_handle_interrupt(canaero_init_t* cfg)
+{
+	struct pollfd p = {cfg->can_dev->fd, POLLIN, 0};
+
+	if (s_activate)
+		return CAN_INTERRUPT;
+	if (p.fd < 0 || poll(&p, 1, 0) <= 0)
+		return CAN_NOINTERRUPT;
+	return CAN_INTERRUPT;
+}
+
+static uint8_t is_service_request(uint16_t id)
+{
+	if (id & 1)
+		return 0;
+	return (id >= SVC_HIGH_FIRST && id < SVC_HIGH_END)
+		|| (id >= SVC_LOW_FIRST && id < SVC_LOW_END);
+}
+
+static void can_dispatch(canaero_init_t* cfg, can_msg_t* msg)
+{
+	if (!is_service_request(msg->id) || msg->length < 4) {
+		if (cfg->incoming_msg_dispatcher_fn
+			&& !cfg->can_settings.filters.filtering_on)
+			cfg->incoming_msg_dispatcher_fn(msg);
+		return;
+	}
+	if (msg->data[0] != 0 && msg->data[0] != cfg->node_id)
+		return;
+	if (msg->data[2] >= SVC_NUM || !cfg->nsl_dispatcher_fn_array[msg->data[2]])
+		return;
+	service_msg_id_t svc = {msg->id, msg->data[0]};
+	++s_svc;
+	cfg->nsl_dispatcher_fn_array[msg->data[2]](cfg, &svc, msg);
+}
+
+void canaero_poll_messages(canaero_init_t* cfg)
+{
+	struct can_frame f;
+	can_msg_t msg;
+
+	if (s_activate) {
+		// MCS 0, active, filters as they are
+		s_activate = 0;
+		memset(&msg, 0, sizeof(msg));
+		msg.id = SVC_HIGH_FIRST;
+		msg.length = 6;
+		msg.data[0] = cfg->node_id;
+		msg.data[1] = UCHAR2;
+		msg.data[2] = 13;
+		msg.data[5] = cfg->can_settings.filters.filtering_on;
+		can_dispatch(cfg, &msg);
+	}
+	if (cfg->can_dev->fd < 0)
+		return;
+	while (read(cfg->can_dev->fd, &f, sizeof(f)) == sizeof(f)) {
+		memset(&msg, 0, sizeof(msg));
+		msg.id = f.can_id & CAN_SFF_MASK;
+		msg.length = f.can_dlc;
+		memcpy(msg.data, f.data, f.can_dlc);
+		++s_rx;
+		can_dispatch(cfg, &msg);
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void get_ids_data(can_msg_t* msg)
+{
+	msg->data[4] = HARDWARE_REVISION;
+	msg->data[5] = APP_VERSION_MAJOR * 16 + APP_VERSION_MINOR;
+	msg->data[6] = 0;
+	msg->data[7] = 0;
+}
+
+int canaero_reply_ids(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {UCHAR4, 0, msg->data[3], get_ids_data};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
+
+int canaero_reply_nis(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {NODATA, 11, msg->data[3], 0};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
+
+int canaero_reply_bss(canaero_init_t* cfg, service_msg_id_t* svc,
+					  can_msg_t* msg)
+{
+	canaero_svc_msg_tmpl_t t = {NODATA, 10, msg->data[3], 0};
+	return canaero_send_svc_reply_message(cfg, svc, &t);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void can_summary(void)
+{
+	fprintf(stderr, "host: can %" PRIu32 " frames sent, %" PRIu32
+			" received, %" PRIu32 " service requests\n", s_tx, s_rx, s_svc);
+}
@@ -0,0 +1,183 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fft.h"
+#include "vib.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * accuracy and speed of fft.c and the vibration monitor on the host
+ *
+ *   ./build-host/fft_bench
+ *
+ * random sines with an offset and noise, in accelerometer counts:
+ *   fft_bins       bin amplitudes against a double precision DFT of
+ *                  the same scaled, windowed block, in lsb of the
+ *                  FFT_HEADROOM full scale
+ *   vib_frequency  the dominant frequency, hz
+ *   vib_amplitude  its amplitude, percent
+ *   vib_rms        band rms, percent, of a sine in the band
+ *   fft_real       host time of a whole transform
+ * the avr cycle counts are the fft_* lines of "make bench". Fails if
+ * an error is over the bounds in fft.h and vib.h.
+ */
+
+#define BENCH_BLOCKS    2000
+#define BENCH_SPEED     100000
+
+// the bounds of fft.h and vib.h, lsb, hz and percent
+#define BINS_BOUND_LSB  5.0
+#define VIB_BOUND_HZ    0.05
+#define VIB_BOUND_PCT   4.0
+
+static int s_failed;
+
+// the monitor runs whenever it is asked, and takes no time
+uint8_t sched_idle(uint16_t us)
+{
+	return 1;
+}
+
+void hal_busy(uint16_t us)
+{
+}
+
+/*-----------------------------------------------------------------------*/
+
+static double rnd(double lo, double hi)
+{
+	return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+// a sine of 'amp' counts at 'hz' on an offset, with +-'noise' counts
+static void block(int16_t* x, double hz, double amp, double noise)
+{
+	double ph = rnd(0, 2 * M_PI);
+	double mean = rnd(-300, 300);
+	for (int i=0; i<FFT_SIZE; ++i)
+		x[i] = (int16_t)lrint(mean + amp * sin(2 * M_PI * hz * i
+			/ ACCEL_SAMPLE_HZ + ph) + rnd(-noise, noise));
+}
+
+// 1 and a note if 'worst' is over 'bound'
+static int failed(const char* name, double worst, double bound)
+{
+	if (worst <= bound)
+		return 0;
+	printf("%-14s FAILED, over %g\n", name, bound);
+	return 1;
+}
+
+static void bench_bins(void)
+{
+	double worst = 0, sq = 0;
+	int n = 0;
+
+	for (int b=0; b<BENCH_BLOCKS; ++b) {
+		int16_t x[FFT_SIZE];
+		double w[FFT_SIZE];
+		block(x, rnd(1, ACCEL_SAMPLE_HZ / 2 - 1), rnd(1, 4000), 10);
+
+		int32_t sum = 0;
+		int16_t lo = x[0], hi = x[0];
+		for (int i=0; i<FFT_SIZE; ++i) {
+			sum += x[i];
+			lo = (x[i] < lo) ? x[i] : lo;
+			hi = (x[i] > hi) ? x[i] : hi;
+		}
+		int16_t mean = sum >> FFT_LOG2;
+		uint8_t shift = fft_scale((hi - mean > mean - lo) ? hi - mean
+								  : mean - lo);
+		for (int i=0; i<FFT_SIZE; ++i)
+			w[i] = (x[i] - mean) * (double)(1 << shift)
+				* 0.5 * (1 - cos(2 * M_PI * i / FFT_SIZE));
+		fft_real(x, mean, shift);
+
+		for (int k=1; k<FFT_BINS; ++k) {
+			double re = 0, im = 0;
+			for (int i=0; i<FFT_SIZE; ++i) {
+				re += w[i] * cos(2 * M_PI * k * i / FFT_SIZE);
+				im -= w[i] * sin(2 * M_PI * k * i / FFT_SIZE);
+			}
+			double e = sqrt((double)fft_power(x, k))
+				- sqrt(re * re + im * im) * 2 / FFT_SIZE;
+			worst = fmax(worst, fabs(e));
+			sq += e * e;
+			++n;
+		}
+	}
+	printf("fft_bins       worst %.2f lsb, rms %.2f lsb of %d\n",
+		   worst, sqrt(sq / n), FFT_HEADROOM);
+	s_failed |= failed("fft_bins", worst, BINS_BOUND_LSB);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void bench_vib(void)
+{
+	double df = 0, da = 0, dr = 0;
+	double lo_hz = VIB_BIN_LO * (double)ACCEL_SAMPLE_HZ / FFT_SIZE + 1;
+
+	vib_init();
+	for (int b=0; b<BENCH_BLOCKS; ++b) {
+		int16_t x[FFT_SIZE];
+		double hz = rnd(lo_hz, ACCEL_SAMPLE_HZ / 2.0 - 2);
+		double amp = rnd(20, 2000);
+		block(x, hz, amp, 2);
+
+		uint16_t done = vib_blocks();
+		for (int i=0; i<FFT_SIZE; ++i)
+			vib_sample(x[i]);
+		while (vib_blocks() == done)
+			vib_task();
+
+		double mg = amp * 1000 / ACCEL_LSB_PER_G;
+		df = fmax(df, fabs(vib_frequency() * 0.01 - hz));
+		da = fmax(da, fabs(vib_amplitude() / mg - 1) * 100);
+		dr = fmax(dr, fabs(vib_rms() / (mg / sqrt(2)) - 1) * 100);
+	}
+	printf("vib_frequency  worst %.3f hz, bins of %.3f hz\n",
+		   df, (double)ACCEL_SAMPLE_HZ / FFT_SIZE);
+	printf("vib_amplitude  worst %.2f %%\n", da);
+	printf("vib_rms        worst %.2f %%\n", dr);
+	s_failed |= failed("vib_frequency", df, VIB_BOUND_HZ);
+	s_failed |= failed("vib_amplitude", da, VIB_BOUND_PCT);
+	s_failed |= failed("vib_rms", dr, VIB_BOUND_PCT);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void bench_speed(void)
+{
+	int16_t x[FFT_SIZE], y[FFT_SIZE];
+	struct timespec t0, t1;
+	volatile uint32_t sink = 0;
+
+	block(x, 37, 1000, 10);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (int n=0; n<BENCH_SPEED; ++n) {
+		for (int i=0; i<FFT_SIZE; ++i)
+			y[i] = x[i];
+		fft_real(y, 0, 2);
+		sink += fft_power(y, n & (FFT_BINS - 2) ? n & (FFT_BINS - 1) : 1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec))
+		/ BENCH_SPEED;
+	printf("fft_real       %.0f ns on the host\n", ns);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+	srand(1);
+	printf("fft of %d samples at %d hz\n", FFT_SIZE, ACCEL_SAMPLE_HZ);
+	bench_bins();
+	bench_vib();
+	bench_speed();
+	return s_failed;
+}
@@ -0,0 +1,171 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fixmath.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * accuracy of the fixmath.c kernels against double precision
+ *
+ *   ./build-host/fixmath_check
+ *
+ * sweeps the input range of each kernel, every input for fix_sincos
+ * and around every square for fix_isqrt32, random and log spread
+ * inputs for the others, and prints the worst error. Fails if one is
+ * over the bound in fixmath.h.
+ */
+
+#define CHECK_RANDOM        2000000
+
+// the bounds of fixmath.h
+#define ATAN2_DEG           0.004
+#define SINCOS_LSB          6
+#define RSQRT_REL           4.5e-5
+#define LOG2_LSB            6
+#define EXP2_REL            2.1e-5
+#define EXP2_LSB            2
+
+static int s_failed;
+
+/*-----------------------------------------------------------------------*/
+
+static uint32_t rnd32(void)
+{
+	static uint32_t s = 1;
+	s = s * 1664525UL + 1013904223UL;
+	uint32_t hi = s >> 16;
+	s = s * 1664525UL + 1013904223UL;
+	return (hi << 16) | (s >> 16);
+}
+
+// spread over the powers of 2, so small inputs get their share
+static uint32_t rnd_log(void)
+{
+	return rnd32() >> (rnd32() % 32);
+}
+
+static void report(const char* name, double worst, double bound,
+				   const char* unit)
+{
+	int bad = worst > bound;
+	printf("%-12s worst %.3g %s, bound %.3g%s\n", name, worst, unit, bound,
+		   bad ? "  FAILED" : "");
+	s_failed |= bad;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void check_atan2(void)
+{
+	double worst = 0;
+	for (long n=0; n<CHECK_RANDOM; ++n) {
+		int32_t y = (int32_t)rnd_log() * ((rnd32() & 1) ? -1 : 1);
+		int32_t x = (int32_t)rnd_log() * ((rnd32() & 1) ? -1 : 1);
+		if (x == 0 && y == 0)
+			continue;
+		double want = atan2((double)y, (double)x) * 180 / M_PI;
+		double got = (double)fix_atan2(y, x) * 360 / 4294967296.0;
+		double e = fabs(remainder(got - want, 360));
+		if (e > worst)
+			worst = e;
+	}
+	report("fix_atan2", worst, ATAN2_DEG, "deg");
+}
+
+static void check_sincos(void)
+{
+	double worst = 0;
+	for (uint32_t a=0; a<65536; ++a) {
+		int16_t s, c;
+		fix_sincos(a, &s, &c);
+		double r = a * 2 * M_PI / 65536;
+		double want_s = fmin(sin(r) * 32768, FIX_Q15_ONE);
+		double want_c = fmin(cos(r) * 32768, FIX_Q15_ONE);
+		worst = fmax(worst, fabs(s - want_s));
+		worst = fmax(worst, fabs(c - want_c));
+	}
+	report("fix_sincos", worst, SINCOS_LSB, "lsb");
+}
+
+static void check_isqrt32(void)
+{
+	double worst = 0;
+	for (uint32_t k=0; k<65536; ++k) {
+		uint32_t sq = k * k;
+		uint32_t v[3] = {sq, sq - 1, sq + 2 * k};
+		for (uint8_t i=0; i<3; ++i) {
+			if (k == 0 && i == 1)
+				continue;
+			double want = floor(sqrt((double)v[i]));
+			worst = fmax(worst, fabs(fix_isqrt32(v[i]) - want));
+		}
+	}
+	report("fix_isqrt32", worst, 0, "lsb");
+}
+
+static void check_rsqrt32(void)
+{
+	double worst = 0;
+	if (fix_rsqrt32(0) != UINT32_MAX)
+		worst = 1;
+	for (long n=0; n<CHECK_RANDOM; ++n) {
+		// every input is scaled into 2^30 .. 2^32 first, that range
+		// in even steps, and random ones for the scaling
+		uint32_t v = (n & 1) ? rnd_log() : 0x40000000UL + n / 2 * 3217;
+		if (v == 0)
+			continue;
+		double want = 2147483648.0 / sqrt((double)v);
+		worst = fmax(worst, fabs(fix_rsqrt32(v) / want - 1));
+	}
+	report("fix_rsqrt32", worst, RSQRT_REL, "rel");
+}
+
+static void check_log2(void)
+{
+	double worst = 0;
+	if (fix_log2(0) != INT32_MIN)
+		worst = 1e9;
+	for (long n=0; n<CHECK_RANDOM; ++n) {
+		uint32_t v = rnd_log();
+		if (v == 0)
+			continue;
+		double want = log2((double)v) * 65536;
+		worst = fmax(worst, fabs(fix_log2(v) - want));
+	}
+	report("fix_log2", worst, LOG2_LSB, "lsb");
+}
+
+static void check_exp2(void)
+{
+	double rel = 0, lsb = 0;
+	for (long n=0; n<CHECK_RANDOM; ++n) {
+		// -32.0 .. 16.0, saturated above
+		int32_t x = (int32_t)(rnd32() % (48UL << 16)) - (32L << 16);
+		double want = exp2(x / 65536.0) * 65536;
+		uint32_t got = fix_exp2(x);
+		if (x < 0)
+			lsb = fmax(lsb, fabs(got - want));
+		else
+			rel = fmax(rel, fabs(got / want - 1));
+	}
+	if (fix_exp2(16L << 16) != UINT32_MAX
+		|| fix_exp2(INT32_MAX) != UINT32_MAX)
+		rel = 1;
+	report("fix_exp2", rel, EXP2_REL, "rel");
+	report("fix_exp2 <1", lsb, EXP2_LSB, "lsb");
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+	check_atan2();
+	check_sincos();
+	check_isqrt32();
+	check_rsqrt32();
+	check_log2();
+	check_exp2();
+	return s_failed;
+}
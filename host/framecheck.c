@@ -0,0 +1,86 @@
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "telem.h"
+#include "trace.h"
+#include "globals.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * the uart framing, telem.c and trace.c against the tools
+ *
+ *   ./build-host/frame_check | python3 host/framecheck.py
+ *
+ * writes FRAME_STEPS telemetry frames with trace records and text
+ * lines in between, the way the main loop mixes them. Step i has
+ *   jiffie    i * 125
+ *   gyro      i, 10 - i, 0x0a0d
+ *   accel     -i, 0, 13 * i
+ *   pressure  100000 + i, 0x0a0d0a00
+ *   temp      i - 400
+ * a trace record every 3rd step, TRACE_MCS_REPLY i, i & 0xff, and a
+ * text line "text <i>" every 7th. framecheck.py knows the pattern,
+ * the values put zeros, '\n' and '\r' all over the frames.
+ */
+
+#define FRAME_STEPS     1000
+
+static uint32_t s_jiffie;
+static uint16_t s_step;
+
+struct bmp085_dev_t g_bmp085_data[2];
+
+/*-----------------------------------------------------------------------*/
+
+uint32_t jiffie(void)
+{
+	return s_jiffie;
+}
+
+int16_t gyro_rate(uint8_t axis)
+{
+	if (axis == 0)
+		return s_step;
+	if (axis == 1)
+		return 10 - s_step;
+	return 0x0a0d;
+}
+
+int16_t accel_value(uint8_t axis)
+{
+	if (axis == 0)
+		return -s_step;
+	if (axis == 1)
+		return 0;
+	return 13 * s_step;
+}
+
+uint8_t baro_board_temperature(int16_t* temp)
+{
+	*temp = s_step - 400;
+	return 0;
+}
+
+uint8_t hal_uart_tx_idle(void)
+{
+	return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+	telem_enable(1);
+	for (s_step=0; s_step<FRAME_STEPS; ++s_step) {
+		s_jiffie = s_step * 125UL;
+		g_bmp085_data[0].press = 100000 + s_step;
+		g_bmp085_data[1].press = 0x0a0d0a00;
+		if (s_step % 3 == 0)
+			trace(TRACE_MCS_REPLY, s_step, s_step & 0xff, 0);
+		telem_frame();
+		trace_drain();
+		if (s_step % 7 == 0)
+			printf("text %u\n", s_step);
+	}
+	return 0;
+}
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+#
+# check tools/telemcap.py and tools/tracedec.py against the output of
+# frame_check, see framecheck.c
+#
+# usage: frame_check | framecheck.py
+#
+# the stream as it is, with '\r\n' line ends from the uart driver, and
+# with every 10th telemetry frame hit by a bad byte. Exits 1 if any
+# frame, record or text line doesn't come out as it went in.
+#
+
+import os
+import subprocess
+import sys
+
+FRAME_STEPS = 1000
+
+TOOLS = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..',
+                     'tools')
+
+
+def expected_frames(skip=()):
+    rows = []
+    for i in range(FRAME_STEPS):
+        if i in skip:
+            continue
+        rows.append('%d,%.4f,%d,%d,%d,%d,%d,%d,%d,%d,%.1f' % (
+            i & 0xff, i * 125 / 10000.0, i, 10 - i, 0x0a0d, -i, 0, 13 * i,
+            100000 + i, 0x0a0d0a00, (i - 400) / 10.0))
+    return rows
+
+
+def expected_trace():
+    lines = []
+    for i in range(FRAME_STEPS):
+        if i % 3 == 0:
+            lines.append('[%7.4f] MCS_REPLY: replied to MCS code %u, '
+                         'status %u' % ((i * 125 & 0xffff) / 10000.0, i,
+                                        i & 0xff))
+        if i % 7 == 0:
+            lines.append('text %u' % i)
+    return lines
+
+
+def run(tool, stream):
+    p = subprocess.run([sys.executable, os.path.join(TOOLS, tool)],
+                       input=stream, capture_output=True, check=True)
+    return (p.stdout.decode('ascii', 'replace').splitlines(),
+            p.stderr.decode('ascii', 'replace'))
+
+
+def check(name, got, want):
+    if got == want:
+        return 0
+    for n, (g, w) in enumerate(zip(got, want)):
+        if g != w:
+            break
+    else:
+        n = min(len(got), len(want))
+    sys.stderr.write('%s: line %d differs, %d lines, want %d\n  %r\n  %r\n'
+                     % (name, n, len(got), len(want),
+                        got[n] if n < len(got) else None,
+                        want[n] if n < len(want) else None))
+    return 1
+
+
+def main():
+    stream = sys.stdin.buffer.read()
+    texts = len([i for i in range(FRAME_STEPS) if i % 7 == 0])
+    crlf = stream.replace(b'\n', b'\r\n')
+
+    # every 10th telemetry frame gets a bad byte, the others and
+    # the trace records and text lines stay as they are
+    hit = set(range(5, FRAME_STEPS, 10))
+    lines = stream.split(b'\n')
+    frame = 0
+    for n, line in enumerate(lines):
+        if line.startswith(b'text') or not line:
+            continue
+        if len(line) < 20:
+            continue        # a trace record
+        if frame in hit:
+            line = bytearray(line)
+            k = len(line) // 2
+            line[k] = 0x20 if line[k] != 0x20 else 0x21
+            lines[n] = bytes(line)
+        frame += 1
+    bad = b'\n'.join(lines)
+
+    errors = 0
+    for name, data, skip in (('plain', stream, ()), ('crlf', crlf, ()),
+                             ('hit', bad, hit)):
+        rows, summary = run('telemcap.py', data)
+        errors += check('telemcap ' + name, rows[1:], expected_frames(skip))
+        want = '%d frames, %d lost, %d bad or text lines' % (
+            FRAME_STEPS - len(skip), len(skip), texts + len(skip))
+        errors += check('telemcap ' + name + ' summary',
+                        summary.splitlines(), [want])
+    for name, data in (('plain', stream), ('crlf', crlf)):
+        out, _ = run('tracedec.py', data)
+        errors += check('tracedec ' + name,
+                        [line.rstrip('\r') for line in out], expected_trace())
+
+    print('frames %s' % ('bad' if errors else 'ok'))
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
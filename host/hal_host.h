@@ -0,0 +1,61 @@
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include <inttypes.h>
+
+#include "defs.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * linux backend of hal.h, see host.c
+ */
+
+// interrupt handlers are plain functions, host.c calls them when the
+// simulated line fires and the interrupt is armed
+#define ISR(vector)             void vector(void)
+#define INT4_vect               host_int4_vect
+#define INT5_vect               host_int5_vect
+#define INT6_vect               host_int6_vect
+#define INT7_vect               host_int7_vect
+
+extern void host_int4_vect(void);
+extern void host_int5_vect(void);
+extern void host_int6_vect(void);
+extern void host_int7_vect(void);
+
+/*-----------------------------------------------------------------------*/
+
+extern void hal_clock_init(void);
+extern void hal_console_init(void);
+extern void hal_irq_enable(void);
+
+#define hal_led_on(n)           host_led((n), 1)
+#define hal_led_off(n)          host_led((n), 0)
+extern void host_led(uint8_t led, uint8_t on);
+
+extern void hal_baro_enable(uint8_t mask);
+extern uint8_t hal_gyro_drdy(void);
+extern void hal_gyro_select(void);
+extern void hal_gyro_deselect(void);
+extern uint8_t hal_spi_transfer(uint8_t b);
+
+extern void hal_extint_rising(uint8_t pin);
+extern void hal_extint_arm(uint8_t pin);
+extern void hal_extint_disable(uint8_t pin);
+
+extern uint16_t hal_timer1_count(void);
+extern uint8_t hal_timer1_match(void);
+
+extern uint8_t hal_uart_tx_idle(void);
+
+// a pretend ram area, the stack numbers mean nothing on the host
+extern uint8_t* hal_ram_start(void);
+extern uint8_t* hal_heap_start(void);
+extern uint8_t* hal_ram_end(void);
+extern uint8_t* hal_stack_pointer(void);
+
+// the firmware takes no virtual time, background work says what it
+// would take on the target
+extern void hal_busy(uint16_t us);
+
+#endif  // HAL_HOST_H_
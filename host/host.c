@@ -0,0 +1,449 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "host.h"
+#include "hal.h"
+#include "timer.h"
+#include "timer1.h"
+#include "uart.h"
+#include "spi.h"
+#include "gpio.h"
+#include "watchdog.h"
+#include "conversion.h"
+#include "jitter.h"
+#include <avr/eeprom.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * environment
+ *   AHRS_SCRIPT    sensor script, see sensors.c
+ *   AHRS_SECONDS   virtual seconds to run, default the script length,
+ *                  or 10 without a script
+ *   AHRS_PASS_US   virtual us per main loop pass, default HOST_PASS_US,
+ *                  0 goes straight to the next event
+ *   AHRS_REALTIME  1 to keep virtual time behind the wall clock
+ *   AHRS_EEPROM    eeprom image file, default ahrs.eep
+ *   AHRS_CAN       SocketCAN interface, e.g. vcan0, see can.c
+ *   AHRS_CAN_LOG   file every CAN frame sent is written to, see can.c
+ */
+
+// virtual time, us
+static uint64_t s_now;
+static uint64_t s_end;
+static uint64_t s_next_tick;
+static uint64_t s_pass_us;
+static uint32_t s_passes;
+
+// wall clock at start up, for AHRS_REALTIME
+static uint8_t s_realtime;
+static struct timespec s_wall_start;
+
+static uint8_t s_irq_enabled;
+static uint8_t s_extint_mask;
+static timer1_compare_fn* s_timer1_cb;
+static uint8_t s_leds[3];
+
+// watchdog, kicked by the loop, checked by SIGALRM on the wall clock
+static volatile sig_atomic_t s_kicked;
+static uint16_t s_watchdog_resets;
+
+// eeprom image
+static uint8_t s_eeprom[E2END + 1];
+static uint8_t s_eeprom_loaded;
+
+// pretend ram for the stack monitor
+static uint8_t s_ram[512];
+
+/*-----------------------------------------------------------------------*/
+
+const char* host_env(const char* name, const char* def)
+{
+	const char* v = getenv(name);
+	return (v && *v) ? v : def;
+}
+
+uint64_t host_now(void)
+{
+	return s_now;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void host_irq(uint8_t pin)
+{
+	if (!s_irq_enabled || !(s_extint_mask & (1 << pin)))
+		return;
+	switch (pin) {
+	case 4:
+		host_int4_vect();
+		break;
+	case 5:
+		host_int5_vect();
+		break;
+	case 6:
+		host_int6_vect();
+		break;
+	default:
+		break;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+// deliver the events up to 'target' in time order
+static void host_advance(uint64_t target)
+{
+	for (;;) {
+		uint64_t t = sensors_next_event();
+		if (s_next_tick < t)
+			t = s_next_tick;
+		if (t > target)
+			break;
+		s_now = t;
+		if (t == s_next_tick) {
+			s_next_tick += HOST_TICK_US;
+			if (s_irq_enabled && s_timer1_cb)
+				s_timer1_cb();
+		}
+		sensors_event(t);
+	}
+	s_now = target;
+}
+
+// wall clock seconds since start up
+static double host_wall(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - s_wall_start.tv_sec)
+		+ (now.tv_nsec - s_wall_start.tv_nsec) / 1e9;
+}
+
+// the 80hz frame periods of jitter.c, the execution times are 0 here
+static void host_jitter(void)
+{
+	can_msg_t msg;
+
+	fprintf(stderr, "host: frame periods");
+	for (uint8_t i=0; i<JITTER_BUCKETS; ++i) {
+		jitter_select(i);
+		jitter_mis_bucket_data(&msg);
+		unsigned n = (msg.data[4] << 8) | msg.data[5];
+		if (n)
+			fprintf(stderr, " %u-%ums %u", i * JITTER_PERIOD_WIDTH / 10,
+					(i + 1) * JITTER_PERIOD_WIDTH / 10, n);
+	}
+	jitter_mis_misses_data(&msg);
+	fprintf(stderr, ", %u late\n", (msg.data[4] << 8) | msg.data[5]);
+}
+
+static void host_exit(void)
+{
+	double wall = host_wall();
+	double hours = s_now / 3.6e9;
+
+	fflush(stdout);
+	fprintf(stderr, "host: %" PRIu64 ".%03" PRIu64 " s, %" PRIu32
+			" loop passes, %u watchdog resets\n",
+			s_now / 1000000, s_now / 1000 % 1000, s_passes,
+			s_watchdog_resets);
+	// replay speed, simulated hours per wall second
+	if (wall > 0)
+		fprintf(stderr, "host: %.3f s wall, %.4f simulated h/s, %.0fx real"
+				" time\n", wall, hours / wall, s_now / 1e6 / wall);
+	host_jitter();
+	can_summary();
+}
+
+// the loop is stuck, on the target this is a reset
+static void host_watchdog(int sig)
+{
+	if (s_kicked) {
+		s_kicked = 0;
+		return;
+	}
+	static const char msg[] = "host: watchdog, the main loop stopped\n";
+	if (write(2, msg, sizeof(msg) - 1) < 0)
+		_exit(3);
+	_exit(2);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// hal.h
+
+void hal_clock_init(void)
+{
+	const char* script = host_env("AHRS_SCRIPT", 0);
+
+	sensors_init();
+	// a script runs to its end
+	if (getenv("AHRS_SECONDS"))
+		s_end = (uint64_t)(atof(getenv("AHRS_SECONDS")) * 1e6);
+	else if (!script)
+		s_end = 10000000ULL;
+	const char* pass = host_env("AHRS_PASS_US", 0);
+	s_pass_us = pass ? strtoul(pass, 0, 10) : HOST_PASS_US;
+	s_realtime = atoi(host_env("AHRS_REALTIME", "0")) != 0;
+	clock_gettime(CLOCK_MONOTONIC, &s_wall_start);
+	s_next_tick = HOST_TICK_US;
+	atexit(host_exit);
+}
+
+void hal_console_init(void)
+{
+	// stdout is the uart, it carries binary frames too
+	setvbuf(stdout, 0, _IOFBF, 4096);
+}
+
+void hal_irq_enable(void)
+{
+	s_irq_enabled = 1;
+}
+
+void host_led(uint8_t led, uint8_t on)
+{
+	s_leds[led] = on;
+}
+
+void hal_extint_rising(uint8_t pin)
+{
+}
+
+void hal_extint_arm(uint8_t pin)
+{
+	s_extint_mask |= 1 << pin;
+}
+
+void hal_extint_disable(uint8_t pin)
+{
+	s_extint_mask &= ~(1 << pin);
+}
+
+uint16_t hal_timer1_count(void)
+{
+	return (uint16_t)(HOST_TICK_US - (s_next_tick - s_now));
+}
+
+uint8_t hal_timer1_match(void)
+{
+	// ticks are delivered as soon as they are due
+	return 0;
+}
+
+uint8_t hal_uart_tx_idle(void)
+{
+	return 1;
+}
+
+uint8_t* hal_ram_start(void)
+{
+	return s_ram;
+}
+
+uint8_t* hal_heap_start(void)
+{
+	return s_ram + sizeof(s_ram) / 2;
+}
+
+uint8_t* hal_ram_end(void)
+{
+	return s_ram + sizeof(s_ram) - 1;
+}
+
+uint8_t* hal_stack_pointer(void)
+{
+	return s_ram + sizeof(s_ram) - 1;
+}
+
+void hal_busy(uint16_t us)
+{
+	if (s_irq_enabled)
+		host_advance(s_now + us);
+}
+
+/*-----------------------------------------------------------------------*/
+
+// drivers
+
+void gpio_setup(void)
+{
+}
+
+void timer_init(void)
+{
+}
+
+uint32_t jiffie(void)
+{
+	return (uint32_t)(s_now / 100);
+}
+
+uint32_t timer_elapsed(uint32_t start, uint32_t now)
+{
+	return now - start;
+}
+
+void timer1_init(timer1_init_t* settings)
+{
+	s_timer1_cb = settings->compareA_cb;
+}
+
+void uart_init(uint16_t tx_size, uint8_t* tx_buf,
+			   uint16_t rx_size, uint8_t* rx_buf)
+{
+}
+
+int uart_putchar(char c, FILE* stream)
+{
+	return putchar(c);
+}
+
+int uart_getchar(FILE* stream)
+{
+	return getchar();
+}
+
+uint8_t spi_init(uint8_t clock_div)
+{
+	return SPI_OK;
+}
+
+void convert_ushort_to_big_endian(uint16_t v, uint8_t* buf)
+{
+	buf[0] = (uint8_t)(v >> 8);
+	buf[1] = (uint8_t)v;
+}
+
+void convert_float_to_big_endian(float v, uint8_t* buf)
+{
+	uint32_t u;
+	memcpy(&u, &v, sizeof(u));
+	buf[0] = (uint8_t)(u >> 24);
+	buf[1] = (uint8_t)(u >> 16);
+	buf[2] = (uint8_t)(u >> 8);
+	buf[3] = (uint8_t)u;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// the watchdog marks the main loop passes
+
+void watchdog_init(uint8_t timeout)
+{
+	struct itimerval it = {{1, 0}, {1, 0}};
+
+	s_kicked = 1;
+	signal(SIGALRM, host_watchdog);
+	setitimer(ITIMER_REAL, &it, 0);
+}
+
+void watchdog_reset(void)
+{
+	s_kicked = 1;
+	if (!s_irq_enabled)
+		return;
+
+	++s_passes;
+	if (s_pass_us) {
+		host_advance(s_now + s_pass_us);
+	} else {
+		// nothing changes until the next event
+		uint64_t t = sensors_next_event();
+		host_advance(s_next_tick < t ? s_next_tick : t);
+	}
+	if ((s_end && s_now >= s_end) || sensors_done(s_now))
+		exit(0);
+
+	if (s_realtime) {
+		double ahead = s_now / 1e6 - host_wall();
+		if (ahead > 0) {
+			struct timespec d = {0, (long)(ahead * 1e9)};
+			nanosleep(&d, 0);
+		}
+	}
+}
+
+void watchdog_reset_count_update(void)
+{
+}
+
+void watchdog_print_flags(void)
+{
+}
+
+void watchdog_mis2_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_watchdog_resets, &(msg->data[4]));
+	convert_ushort_to_big_endian(0, &(msg->data[6]));
+}
+
+void watchdog_mis3_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(0, &(msg->data[4]));
+	convert_ushort_to_big_endian(0, &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+// avr/eeprom.h, the image is read on first use and written through
+
+static void eeprom_load(void)
+{
+	if (s_eeprom_loaded)
+		return;
+	s_eeprom_loaded = 1;
+	memset(s_eeprom, 0xff, sizeof(s_eeprom));
+	FILE* f = fopen(host_env("AHRS_EEPROM", "ahrs.eep"), "rb");
+	if (f) {
+		if (fread(s_eeprom, 1, sizeof(s_eeprom), f) == 0)
+			memset(s_eeprom, 0xff, sizeof(s_eeprom));
+		fclose(f);
+	}
+}
+
+static void eeprom_save(void)
+{
+	FILE* f = fopen(host_env("AHRS_EEPROM", "ahrs.eep"), "wb");
+	if (f) {
+		fwrite(s_eeprom, 1, sizeof(s_eeprom), f);
+		fclose(f);
+	}
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+	eeprom_load();
+	return s_eeprom[(uintptr_t)addr & E2END];
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+	for (size_t i=0; i<n; ++i)
+		((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value)
+{
+	eeprom_load();
+	s_eeprom[(uintptr_t)addr & E2END] = value;
+	eeprom_save();
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value)
+{
+	if (eeprom_read_byte(addr) != value)
+		eeprom_write_byte(addr, value);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n)
+{
+	for (size_t i=0; i<n; ++i)
+		eeprom_update_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+}
@@ -0,0 +1,58 @@
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <inttypes.h>
+
+#include "sched.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * simulation core of the host build
+ *
+ * time is virtual. Every main loop pass (watchdog_reset() marks one)
+ * moves it on by HOST_PASS_US, and the timer, sensor and CAN events
+ * that fall in the step are delivered in order, as interrupts where
+ * they are armed. With AHRS_PASS_US=0 a pass goes straight to the
+ * next event, for replaying long logs. The firmware runs as fast as
+ * the host can go, unless AHRS_REALTIME is set in the environment.
+ */
+
+// virtual cost of one main loop pass, us, unless AHRS_PASS_US is set
+#define HOST_PASS_US        50
+
+// scheduler tick, timer1 counts us (clk / 8 at 8mhz)
+#define HOST_TICK_US        (1000000UL / SCHED_TICK_HZ)
+
+// virtual time, us
+extern uint64_t host_now(void);
+
+// external interrupt line 'pin' went high, runs the handler if armed
+extern void host_irq(uint8_t pin);
+
+// environment setting, or 'def' if it isn't set
+extern const char* host_env(const char* name, const char* def);
+
+/*-----------------------------------------------------------------------*/
+
+// sensors.c, scripted gyro, accelerometer and bmp085s
+
+// read the script named by AHRS_SCRIPT
+extern void sensors_init(void);
+
+// time of the next sensor event, DRDY or EOC
+extern uint64_t sensors_next_event(void);
+
+// deliver the sensor events due at 'now'
+extern void sensors_event(uint64_t now);
+
+// 1 once the script has ended, never without a script
+extern uint8_t sensors_done(uint64_t now);
+
+/*-----------------------------------------------------------------------*/
+
+// can.c, the CANaerospace stand-in
+
+// print the frame counts to stderr
+extern void can_summary(void);
+
+#endif  // HOST_H_
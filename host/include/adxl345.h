@@ -0,0 +1,23 @@
+#ifndef ADXL345_H_
+#define ADXL345_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers adxl345, see host/sensors.c */
+
+struct adxl345_device {
+	uint8_t axis_map[3];
+	int8_t sign_map[3];
+};
+
+extern void adxl345_init(struct adxl345_device* dev);
+extern uint8_t adxl345_self_test(void);
+extern void adxl345_internal_self_test(void);
+
+// latch a sample
+extern void adxl345_read_accel(void);
+
+// the latched sample in body axes, raw counts
+extern int16_t adxl345_accel(uint8_t axis);
+
+#endif  // ADXL345_H_
@@ -0,0 +1,17 @@
+#ifndef AT90CAN_H_
+#define AT90CAN_H_
+
+#include "canaero.h"
+
+/* host stand-in, the CAN device is a SocketCAN socket, see host/can.c */
+
+typedef void (can_error_fn)(struct can_device* dev, const can_error_t* err);
+
+struct can_device {
+	can_error_fn* handle_error_fn;
+	int fd;                     // socket, -1 without a bus
+};
+
+extern struct can_device at90can_dev;
+
+#endif  // AT90CAN_H_
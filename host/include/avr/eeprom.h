@@ -0,0 +1,24 @@
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * host stand-in for avr-libc, the eeprom is a file, see host.c
+ */
+
+// at90can32
+#define E2END                   0x3ff
+
+extern uint8_t eeprom_read_byte(const uint8_t* addr);
+extern void eeprom_read_block(void* dst, const void* src, size_t n);
+extern void eeprom_write_byte(uint8_t* addr, uint8_t value);
+extern void eeprom_update_byte(uint8_t* addr, uint8_t value);
+extern void eeprom_update_block(const void* src, void* dst, size_t n);
+
+// writes complete at once
+#define eeprom_is_ready()       1
+
+#endif  // HOST_AVR_EEPROM_H_
@@ -0,0 +1,27 @@
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * host stand-in for avr-libc, flash is ordinary memory here
+ */
+
+#define PROGMEM
+#define PSTR(s)                 (s)
+
+#define pgm_read_byte(p)        (*(const uint8_t*)(p))
+#define pgm_read_word(p)        (*(const uint16_t*)(p))
+#define pgm_read_dword(p)       (*(const uint32_t*)(p))
+
+#define memcpy_P                memcpy
+#define strlen_P                strlen
+
+// avr-libc declares these in stdio.h
+#define printf_P                printf
+#define puts_P                  puts
+
+#endif  // HOST_AVR_PGMSPACE_H_
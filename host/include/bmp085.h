@@ -0,0 +1,20 @@
+#ifndef BMP085_H_
+#define BMP085_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers bmp085, see host/sensors.c */
+
+enum {ULTRALOW, STANDARD, HIGHRES, ULTRAHIGHRES};
+enum {BMP085_OK, BMP085_FAILED};
+
+struct bmp085_dev_t {
+	uint8_t num;
+	int32_t press;              // Pa
+	int16_t temp;               // 0.1 C
+};
+
+extern uint8_t bmp085_init(uint8_t mode, struct bmp085_dev_t* dev);
+extern uint8_t bmp085_self_test(struct bmp085_dev_t* dev);
+
+#endif  // BMP085_H_
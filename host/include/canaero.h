@@ -0,0 +1,127 @@
+#ifndef CANAERO_H_
+#define CANAERO_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * host stand-in for the CANaerospace stack of avr_drivers/canlibrary,
+ * the parts the firmware uses. Frames go to a SocketCAN interface,
+ * see host/can.c
+ */
+
+struct can_device;
+struct canaero_init;
+
+typedef struct {
+	uint16_t id;
+	uint8_t data[8];
+	uint8_t length;
+} can_msg_t;
+
+// payload types, the values are the CANaerospace codes
+typedef enum {
+	NODATA, ERROR, FLOAT, LONG, ULONG, BLONG, SHORT, USHORT, BSHORT,
+	CHAR, UCHAR, BCHAR, SHORT2, USHORT2, BSHORT2, CHAR4, UCHAR4, BCHAR4,
+	CHAR2, UCHAR2, BCHAR2,
+} canaero_data_type_t;
+
+// message classes
+typedef enum {EED, NOD, UDH, NSH, UDL, DSD} canaero_msg_type_t;
+
+// fills the payload, data[4] on
+typedef void (get_nod_msg_data_fn)(can_msg_t* msg);
+
+typedef struct {
+	canaero_msg_type_t msg_type;
+	uint16_t message_id;
+	uint8_t node_id;
+	canaero_data_type_t data_type;
+	uint8_t service_code;
+	uint8_t message_code;
+	get_nod_msg_data_fn* fn;
+} canaero_msg_tmpl_t;
+
+typedef struct {
+	canaero_data_type_t data_type;
+	uint8_t service_code;
+	uint8_t message_code;
+	get_nod_msg_data_fn* fn;
+} canaero_svc_msg_tmpl_t;
+
+// where a service request came from, the reply goes back on it
+typedef struct {
+	uint16_t request_id;
+	uint8_t node_id;
+} service_msg_id_t;
+
+typedef int (reply_svc_fn)(struct canaero_init* proto, service_msg_id_t* svc,
+						   can_msg_t* msg);
+typedef void (get_incoming_msg_fn)(can_msg_t* msg);
+
+struct emerg_event {
+	uint8_t node;
+	int16_t error_code;
+	uint8_t operation_id;
+	uint8_t location_id;
+};
+
+typedef struct {
+	uint8_t error_code;
+	uint8_t dev_buffer;
+	uint8_t dev_code;
+} can_error_t;
+
+typedef void (emergency_event_fn)(const struct emerg_event* ev);
+
+typedef struct canaero_init {
+	struct {
+		uint8_t speed_setting;
+		uint8_t loopback_on;
+		uint16_t tx_wait_ms;
+		struct {
+			uint8_t filtering_on;
+		} filters;
+	} can_settings;
+	uint8_t node_id;
+	uint8_t svc_channel;
+	canaero_msg_tmpl_t* nod_msg_templates;
+	int num_nod_templates;
+	reply_svc_fn** nsl_dispatcher_fn_array;
+	get_incoming_msg_fn* incoming_msg_dispatcher_fn;
+	emergency_event_fn* emergency_event_fn;
+	struct can_device* can_dev;
+} canaero_init_t;
+
+// return and error codes
+enum {
+	CAN_OK, CAN_FAILINIT, CAN_INTERRUPT, CAN_NOINTERRUPT,
+	CAN_BUS_OFF, CAN_BUS_PASSIVE,
+};
+
+// emergency event codes
+enum {DISPLAY_BUFFER_OVERFLOW = 1};
+
+// bus speeds
+enum {CAN_125KBPS, CAN_250KBPS, CAN_500KBPS, CAN_1000KBPS};
+
+extern int canaero_init(canaero_init_t* cfg, struct can_device* dev);
+extern int canaero_self_test(canaero_init_t* cfg);
+
+// CAN_INTERRUPT if frames are waiting
+extern int canaero_handle_interrupt(canaero_init_t* cfg);
+
+// dispatch the waiting frames
+extern void canaero_poll_messages(canaero_init_t* cfg);
+
+// send nod_msg_templates first .. end-1
+extern int canaero_send_messages(canaero_init_t* cfg, int first, int end);
+
+extern int canaero_send_svc_reply_message(canaero_init_t* cfg,
+										  service_msg_id_t* svc,
+										  canaero_svc_msg_tmpl_t* tmpl);
+
+extern void canaero_reset_nod_message_sequence(canaero_init_t* cfg);
+extern void can_clear_tx_buffers(struct can_device* dev);
+
+#endif  // CANAERO_H_
@@ -0,0 +1,10 @@
+#ifndef CANAERO_BSS_H_
+#define CANAERO_BSS_H_
+
+#include "canaero.h"
+
+/* host stand-in, see host/can.c */
+
+extern reply_svc_fn canaero_reply_bss;
+
+#endif  // CANAERO_BSS_H_
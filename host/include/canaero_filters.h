@@ -0,0 +1,11 @@
+#ifndef CANAERO_FILTERS_H_
+#define CANAERO_FILTERS_H_
+
+#include "canaero.h"
+
+/* host stand-in, see host/can.c */
+
+extern void canaero_high_priority_service_filters(canaero_init_t* cfg);
+extern void canaero_no_filters(canaero_init_t* cfg);
+
+#endif  // CANAERO_FILTERS_H_
@@ -0,0 +1,10 @@
+#ifndef CANAERO_IDS_H_
+#define CANAERO_IDS_H_
+
+#include "canaero.h"
+
+/* host stand-in, see host/can.c */
+
+extern reply_svc_fn canaero_reply_ids;
+
+#endif  // CANAERO_IDS_H_
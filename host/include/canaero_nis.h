@@ -0,0 +1,10 @@
+#ifndef CANAERO_NIS_H_
+#define CANAERO_NIS_H_
+
+#include "canaero.h"
+
+/* host stand-in, see host/can.c */
+
+extern reply_svc_fn canaero_reply_nis;
+
+#endif  // CANAERO_NIS_H_
@@ -0,0 +1,11 @@
+#ifndef CONVERSION_H_
+#define CONVERSION_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers conversions, see host/host.c */
+
+extern void convert_ushort_to_big_endian(uint16_t v, uint8_t* buf);
+extern void convert_float_to_big_endian(float v, uint8_t* buf);
+
+#endif  // CONVERSION_H_
@@ -0,0 +1,21 @@
+#ifndef I2CMASTER_H_
+#define I2CMASTER_H_
+
+#include <inttypes.h>
+
+/* host stand-in for i2cmaster, the bus has the bmp085s, see sensors.c */
+
+#define I2C_READ    1
+#define I2C_WRITE   0
+
+extern void i2c_init(void);
+extern void i2c_stop(void);
+// 0 if the device answered
+extern unsigned char i2c_start(unsigned char addr);
+extern unsigned char i2c_rep_start(unsigned char addr);
+extern void i2c_start_wait(unsigned char addr);
+extern unsigned char i2c_write(unsigned char data);
+extern unsigned char i2c_readAck(void);
+extern unsigned char i2c_readNak(void);
+
+#endif  // I2CMASTER_H_
@@ -0,0 +1,22 @@
+#ifndef L3G4200D_H_
+#define L3G4200D_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers l3g4200d, see host/sensors.c */
+
+typedef struct {
+	int8_t sensor_sign[3];
+	int16_t raw[3];
+} l3g4200d_dev_t;
+
+extern void l3g4200d_init(void);
+extern void l3g4200d_self_test(void);
+
+// read a sample, clears DRDY
+extern void l3g4200d_read_data(l3g4200d_dev_t* dev);
+
+// the sample in body axes, raw counts
+extern int16_t l3g4200d_raw_data(l3g4200d_dev_t* dev, uint8_t axis);
+
+#endif  // L3G4200D_H_
@@ -0,0 +1,12 @@
+#ifndef SPI_H_
+#define SPI_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers spi, nothing is on it */
+
+enum {SPI_OK, SPI_FAILED};
+
+extern uint8_t spi_init(uint8_t clock_div);
+
+#endif  // SPI_H_
@@ -0,0 +1,17 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers timer, see host/host.c */
+
+// start the tenth ms clock
+extern void timer_init(void);
+
+// tenth ms since start up
+extern uint32_t jiffie(void);
+
+// tenth ms from 'start' to 'now'
+extern uint32_t timer_elapsed(uint32_t start, uint32_t now);
+
+#endif  // TIMER_H_
@@ -0,0 +1,24 @@
+#ifndef TIMER1_H_
+#define TIMER1_H_
+
+#include <inttypes.h>
+
+/* host stand-in for the avr_drivers timer1, see host/host.c */
+
+// clock prescaler, the host only runs clk / 8
+enum timer1_scale {CLK1 = 1, CLK8, CLK64, CLK256, CLK1024};
+
+typedef void (timer1_compare_fn)(void);
+
+typedef struct {
+	enum timer1_scale scale;
+	timer1_compare_fn* compareA_cb;
+	timer1_compare_fn* compareB_cb;
+	uint16_t compareA_val;
+	uint16_t compareB_val;
+} timer1_init_t;
+
+// compare A clears the counter and calls compareA_cb
+extern void timer1_init(timer1_init_t* settings);
+
+#endif  // TIMER1_H_
@@ -0,0 +1,14 @@
+#ifndef UART_H_
+#define UART_H_
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/* host stand-in for the avr_drivers uart, the uart is stdin/stdout */
+
+extern void uart_init(uint16_t tx_size, uint8_t* tx_buf,
+					  uint16_t rx_size, uint8_t* rx_buf);
+extern int uart_putchar(char c, FILE* stream);
+extern int uart_getchar(FILE* stream);
+
+#endif  // UART_H_
@@ -0,0 +1,18 @@
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * host stand-in for avr-libc, the simulated interrupts only run
+ * between main loop passes, so a block is atomic as it is
+ */
+
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          0
+
+#define ATOMIC_BLOCK(type) \
+	for (uint8_t host_atomic_ = 1; host_atomic_; host_atomic_ = 0)
+
+#endif  // HOST_UTIL_ATOMIC_H_
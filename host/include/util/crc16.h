@@ -0,0 +1,33 @@
+#ifndef HOST_UTIL_CRC16_H_
+#define HOST_UTIL_CRC16_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * host stand-in for avr-libc, the C equivalents from its manual
+ */
+
+// polynomial 0xa001, 0xffff initial value
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t a)
+{
+	crc ^= a;
+	for (uint8_t i=0; i<8; ++i) {
+		if (crc & 1)
+			crc = (crc >> 1) ^ 0xa001;
+		else
+			crc = (crc >> 1);
+	}
+	return crc;
+}
+
+// polynomial 0x1021, 0xffff initial value
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+	data ^= crc & 0xff;
+	data ^= data << 4;
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4)
+			^ ((uint16_t)data << 3));
+}
+
+#endif  // HOST_UTIL_CRC16_H_
@@ -0,0 +1,22 @@
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/* host stand-in for the avr_drivers watchdog, see host/host.c */
+
+#define WDTO_1S     6
+
+// a main loop pass on the host, see host.h
+extern void watchdog_reset(void);
+
+extern void watchdog_init(uint8_t timeout);
+extern void watchdog_reset_count_update(void);
+extern void watchdog_print_flags(void);
+
+// MIS data, reset counts
+extern void watchdog_mis2_data(can_msg_t* msg);
+extern void watchdog_mis3_data(can_msg_t* msg);
+
+#endif  // WATCHDOG_H_
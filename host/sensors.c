@@ -0,0 +1,702 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "hal.h"
+#include "baro.h"
+#include "globals.h"
+#include "adxl345.h"
+#include "l3g4200d.h"
+#include "bmp085.h"
+#include "i2cmaster.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * scripted sensors
+ *
+ * AHRS_SCRIPT is a text file, one sample per line, '#' starts a
+ * comment:
+ *   time_ms  gx gy gz  ax ay az  static_pa total_pa  [temp_0.1c]
+ * or a csv recorded by tools/telemcap.py, the raw samples of a unit,
+ * so a flight log replays through the same code:
+ *   seq,time_s,gx,gy,gz,ax,ay,az,static_pa,total_pa,temp_c
+ * rates and accelerations are raw counts in body axes, as the drivers
+ * hand them over (gyro pitch, roll, yaw; accel longitudinal, lateral,
+ * normal). Time starts at the first sample, a sample holds until the
+ * time of the next. A log that goes back in time (the unit reset)
+ * carries on from the last sample. The file is read as time passes,
+ * so a log can be any length. Without a script the unit sits level at
+ * sea level.
+ *
+ * the gyro raises DRDY at SENSORS_GYRO_HZ, the bmp085s are simulated
+ * on the i2c bus, with the datasheet example calibration and EOC
+ * after the datasheet conversion time.
+ *
+ * the registers the firmware reads itself with SENSOR_FIFO are there
+ * as well: the l3g4200d FIFO on spi, with the watermark on DRDY/INT2,
+ * and the adxl345 FIFO on i2c at its BW_RATE. Both take the script
+ * samples back through the axis and sign maps, so the firmware ends up
+ * with the script values either way.
+ */
+
+#define SENSORS_GYRO_HZ     400
+#define SENSORS_GYRO_US     (1000000UL / SENSORS_GYRO_HZ)
+
+#define BMP085_ADDR         0x77
+#define BMP085_CAL          0xaa
+#define BMP085_CAL_SIZE     22
+#define BMP085_CONTROL      0xf4
+#define BMP085_ADC          0xf6
+
+#define L3G_CTRL_REG3       0x22
+#define L3G_CTRL_REG5       0x24
+#define L3G_OUT_X_L         0x28
+#define L3G_OUT_Z_H         0x2D
+#define L3G_FIFO_CTRL_REG   0x2E
+#define L3G_FIFO_SRC_REG    0x2F
+#define L3G_I2_WTM          0x04
+#define L3G_FIFO_EN         0x40
+
+#define ADXL345_ADDR        0x53
+#define ADXL_BW_RATE        0x2C
+#define ADXL_DATAX0         0x32
+#define ADXL_DATAZ1         0x37
+#define ADXL_FIFO_CTL       0x38
+#define ADXL_FIFO_STATUS    0x39
+
+#define FIFO_SIZE           32
+
+#define NEVER               UINT64_MAX
+
+struct sample {
+	uint64_t time;
+	int16_t gyro[3];
+	int16_t accel[3];
+	int32_t press[2];
+	int16_t temp;
+};
+
+// datasheet example calibration, ac1 .. md
+static const int16_t k_cal[11] = {
+	408, -72, -14383, (int16_t)32741, (int16_t)32757, 23153,
+	6190, 4, -32768, -8711, 2868,
+};
+
+// a sensor FIFO of raw samples, oldest at tail
+struct fifo_sim {
+	int16_t s[FIFO_SIZE][3];
+	uint8_t tail;
+	uint8_t count;
+	uint8_t overrun;
+};
+
+struct bmp085_sim {
+	uint8_t reg;                // register pointer
+	uint8_t adc[3];
+	uint64_t done;              // end of the conversion, or NEVER
+};
+
+// the script, the sample in force and the one after it
+static FILE* s_script;
+static const char* s_name;
+static unsigned s_line;
+static struct sample s_cur;
+static struct sample s_next;
+static uint8_t s_have_next;
+static uint8_t s_started;
+static int64_t s_offset;        // file time to virtual time, us
+static uint64_t s_last;         // time of the last sample read
+
+static struct sample s_level = {
+	0, {0, 0, 0}, {0, 0, -ACCEL_LSB_PER_G}, {101325, 101325}, 150,
+};
+
+static uint64_t s_next_drdy;
+static uint8_t s_drdy;
+static int16_t s_accel[3];
+
+static struct bmp085_sim s_baro[2];
+static uint8_t s_xclr = 3;
+static int8_t s_bus_dev = -1;   // device addressed, -1 none, 2 adxl345
+static uint8_t s_bus_first;     // next write is the register pointer
+
+// l3g4200d registers, FIFO and the spi transfer
+static uint8_t s_l3g_reg[0x40];
+static struct fifo_sim s_l3g_fifo;
+static int16_t s_l3g_out[3];
+static uint8_t s_spi_cs;
+static uint8_t s_spi_first;     // next byte is the address
+static uint8_t s_spi_addr;
+static uint8_t s_spi_read;
+static uint8_t s_spi_multi;
+
+// adxl345 registers and FIFO, a sample every BW_RATE period
+static uint8_t s_adxl_reg[0x40] = {[ADXL_BW_RATE] = 0x0a};
+static uint8_t s_adxl_ptr;
+static struct fifo_sim s_adxl_fifo;
+static int16_t s_adxl_out[3];
+static uint64_t s_adxl_next;
+
+static void l3g4200d_sample(const struct sample* s);
+static uint64_t adxl345_period(void);
+static void adxl345_sample(const struct sample* s);
+
+/*-----------------------------------------------------------------------*/
+
+// next sample from the script into 's', 0 at the end
+static uint8_t read_sample(struct sample* s)
+{
+	char line[256];
+
+	while (fgets(line, sizeof(line), s_script)) {
+		++s_line;
+		char* c = strchr(line, '#');
+		if (c)
+			*c = 0;
+		double t, temp = 0;
+		int v[9];
+		int got;
+		if (strchr(line, ',')) {
+			// telemcap.py csv, the header doesn't scan
+			unsigned seq;
+			got = sscanf(line, "%u,%lf,%d,%d,%d,%d,%d,%d,%d,%d,%lf", &seq, &t,
+						 &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6],
+						 &v[7], &temp);
+			if (got <= 0)
+				continue;
+			if (got != 11)
+				goto bad;
+			t *= 1000;
+			temp *= 10;
+		} else {
+			got = sscanf(line, "%lf %d %d %d %d %d %d %d %d %d", &t,
+						 &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6],
+						 &v[7], &v[8]);
+			if (got <= 0)
+				continue;
+			if (got < 9)
+				goto bad;
+			temp = (got == 10) ? v[8] : 150;
+		}
+		// time starts at the first sample, and doesn't go back
+		int64_t us = (int64_t)(t * 1000);
+		if (!s_started) {
+			s_started = 1;
+			s_offset = -us;
+		}
+		if (us + s_offset < (int64_t)s_last)
+			s_offset = (int64_t)s_last - us;
+		uint64_t time = us + s_offset;
+		s_last = time;
+		s->time = time;
+		for (uint8_t i=0; i<3; ++i) {
+			s->gyro[i] = v[i];
+			s->accel[i] = v[3 + i];
+		}
+		s->press[0] = v[6];
+		s->press[1] = v[7];
+		s->temp = (int16_t)(temp + (temp < 0 ? -0.5 : 0.5));
+		return 1;
+	}
+	return 0;
+
+bad:
+	fprintf(stderr, "%s:%u: needs 9 or 10 fields, or 11 in a csv\n",
+			s_name, s_line);
+	exit(1);
+}
+
+// sample in force at 'now'
+static const struct sample* sample_at(uint64_t now)
+{
+	if (!s_script)
+		return &s_level;
+	while (s_have_next && s_next.time <= now) {
+		s_cur = s_next;
+		s_have_next = read_sample(&s_next);
+	}
+	return &s_cur;
+}
+
+void sensors_init(void)
+{
+	s_next_drdy = SENSORS_GYRO_US;
+	s_adxl_next = adxl345_period();
+	s_baro[0].done = NEVER;
+	s_baro[1].done = NEVER;
+
+	s_name = host_env("AHRS_SCRIPT", 0);
+	if (!s_name)
+		return;
+	s_script = fopen(s_name, "r");
+	if (!s_script) {
+		perror(s_name);
+		exit(1);
+	}
+	if (!read_sample(&s_cur)) {
+		fprintf(stderr, "%s: no samples\n", s_name);
+		exit(1);
+	}
+	s_have_next = read_sample(&s_next);
+}
+
+uint8_t sensors_done(uint64_t now)
+{
+	return s_script && !s_have_next && now >= s_cur.time;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint64_t sensors_next_event(void)
+{
+	uint64_t t = s_next_drdy;
+	if (s_adxl_next < t)
+		t = s_adxl_next;
+	for (uint8_t i=0; i<2; ++i)
+		if (s_baro[i].done < t)
+			t = s_baro[i].done;
+	return t;
+}
+
+void sensors_event(uint64_t now)
+{
+	if (now == s_next_drdy) {
+		s_next_drdy += SENSORS_GYRO_US;
+		l3g4200d_sample(sample_at(now));
+	}
+	if (now == s_adxl_next) {
+		s_adxl_next += adxl345_period();
+		adxl345_sample(sample_at(now));
+	}
+	for (uint8_t i=0; i<2; ++i) {
+		if (s_baro[i].done == now) {
+			s_baro[i].done = NEVER;
+			host_irq(i == 0 ? P_EOC1 : P_EOC2);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+// sensor FIFOs, stream mode, a full FIFO drops its oldest sample
+
+static void fifo_push(struct fifo_sim* f, const int16_t* v)
+{
+	if (f->count == FIFO_SIZE) {
+		f->tail = (f->tail + 1) % FIFO_SIZE;
+		--f->count;
+		f->overrun = 1;
+	}
+	memcpy(f->s[(f->tail + f->count) % FIFO_SIZE], v, sizeof(f->s[0]));
+	++f->count;
+}
+
+// the oldest sample into 'v' and off the FIFO, if there is one
+static void fifo_pop(struct fifo_sim* f, int16_t* v)
+{
+	if (f->count == 0)
+		return;
+	memcpy(v, f->s[f->tail], sizeof(f->s[0]));
+	f->tail = (f->tail + 1) % FIFO_SIZE;
+	--f->count;
+	f->overrun = 0;
+}
+
+static void fifo_clear(struct fifo_sim* f)
+{
+	f->count = 0;
+	f->overrun = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// l3g4200d registers on spi, what the firmware uses of them
+
+static uint8_t l3g4200d_fifo_mode(void)
+{
+	return (s_l3g_reg[L3G_CTRL_REG5] & L3G_FIFO_EN)
+		&& (s_l3g_reg[L3G_FIFO_CTRL_REG] >> 5) != 0;
+}
+
+// level of DRDY/INT2, data ready or the FIFO watermark
+static uint8_t l3g4200d_line(void)
+{
+	if (s_l3g_reg[L3G_CTRL_REG3] & L3G_I2_WTM)
+		return s_l3g_fifo.count >= (s_l3g_reg[L3G_FIFO_CTRL_REG] & 0x1f);
+	return s_drdy;
+}
+
+static void l3g4200d_sample(const struct sample* s)
+{
+	int16_t raw[3];
+	for (uint8_t i=0; i<3; ++i)
+		raw[i] = s->gyro[i] * g_gyro_dev.sensor_sign[i];
+
+	if (!(s_l3g_reg[L3G_CTRL_REG3] & L3G_I2_WTM)) {
+		// the drivers read the sample on DRDY
+		s_drdy = 1;
+		host_irq(P_GYRODRDY);
+		return;
+	}
+	uint8_t was = l3g4200d_line();
+	if (l3g4200d_fifo_mode())
+		fifo_push(&s_l3g_fifo, raw);
+	else
+		memcpy(s_l3g_out, raw, sizeof(raw));
+	if (!was && l3g4200d_line())
+		host_irq(P_GYRODRDY);
+}
+
+static uint8_t l3g4200d_read_reg(uint8_t reg)
+{
+	if (reg >= L3G_OUT_X_L && reg <= L3G_OUT_Z_H) {
+		if (reg == L3G_OUT_X_L && l3g4200d_fifo_mode())
+			fifo_pop(&s_l3g_fifo, s_l3g_out);
+		uint16_t v = (uint16_t)s_l3g_out[(reg - L3G_OUT_X_L) / 2];
+		return (reg & 1) ? (uint8_t)(v >> 8) : (uint8_t)v;
+	}
+	if (reg == L3G_FIFO_SRC_REG) {
+		const struct fifo_sim* f = &s_l3g_fifo;
+		uint8_t wtm = s_l3g_reg[L3G_FIFO_CTRL_REG] & 0x1f;
+		return (f->count >= wtm ? 0x80 : 0) | (f->overrun ? 0x40 : 0)
+			| (f->count == 0 ? 0x20 : 0) | (f->count & 0x1f);
+	}
+	return s_l3g_reg[reg];
+}
+
+static void l3g4200d_write_reg(uint8_t reg, uint8_t v)
+{
+	s_l3g_reg[reg] = v;
+	// bypass mode empties the FIFO
+	if (reg == L3G_FIFO_CTRL_REG && (v >> 5) == 0)
+		fifo_clear(&s_l3g_fifo);
+}
+
+void hal_gyro_select(void)
+{
+	s_spi_cs = 1;
+	s_spi_first = 1;
+}
+
+void hal_gyro_deselect(void)
+{
+	s_spi_cs = 0;
+}
+
+uint8_t hal_spi_transfer(uint8_t b)
+{
+	if (!s_spi_cs)
+		return 0xff;
+	if (s_spi_first) {
+		s_spi_first = 0;
+		s_spi_addr = b & 0x3f;
+		s_spi_read = b & 0x80;
+		s_spi_multi = b & 0x40;
+		return 0xff;
+	}
+	uint8_t reg = s_spi_addr;
+	if (s_spi_multi) {
+		// a FIFO burst rolls back from OUT_Z_H to OUT_X_L
+		if (reg == L3G_OUT_Z_H && l3g4200d_fifo_mode())
+			s_spi_addr = L3G_OUT_X_L;
+		else
+			s_spi_addr = (reg + 1) & 0x3f;
+	}
+	if (s_spi_read)
+		return l3g4200d_read_reg(reg);
+	l3g4200d_write_reg(reg, b);
+	return 0xff;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// adxl345 registers on i2c
+
+// time between samples at the BW_RATE
+static uint64_t adxl345_period(void)
+{
+	uint8_t code = s_adxl_reg[ADXL_BW_RATE] & 0x0f;
+	uint32_t hz = 3200UL >> (15 - code);
+	return 1000000UL / (hz ? hz : 1);
+}
+
+static void adxl345_sample(const struct sample* s)
+{
+	int16_t raw[3];
+	for (uint8_t i=0; i<3; ++i)
+		raw[g_adxl345_dev.axis_map[i]] =
+			s->accel[i] * g_adxl345_dev.sign_map[i];
+	if (s_adxl_reg[ADXL_FIFO_CTL] >> 6)
+		fifo_push(&s_adxl_fifo, raw);
+	else
+		memcpy(s_adxl_out, raw, sizeof(raw));
+}
+
+static uint8_t adxl345_read_reg(void)
+{
+	uint8_t reg = s_adxl_ptr;
+	s_adxl_ptr = (reg + 1) & 0x3f;
+	if (reg >= ADXL_DATAX0 && reg <= ADXL_DATAZ1) {
+		if (reg == ADXL_DATAX0 && (s_adxl_reg[ADXL_FIFO_CTL] >> 6))
+			fifo_pop(&s_adxl_fifo, s_adxl_out);
+		uint16_t v = (uint16_t)s_adxl_out[(reg - ADXL_DATAX0) / 2];
+		return (reg & 1) ? (uint8_t)(v >> 8) : (uint8_t)v;
+	}
+	if (reg == ADXL_FIFO_STATUS)
+		return s_adxl_fifo.count;
+	return s_adxl_reg[reg];
+}
+
+static void adxl345_write(uint8_t data)
+{
+	if (s_bus_first) {
+		s_adxl_ptr = data & 0x3f;
+		s_bus_first = 0;
+		return;
+	}
+	uint8_t reg = s_adxl_ptr;
+	s_adxl_ptr = (reg + 1) & 0x3f;
+	s_adxl_reg[reg] = data;
+	// bypass mode empties the FIFO, the data registers get the newest
+	if (reg == ADXL_FIFO_CTL && (data >> 6) == 0) {
+		struct fifo_sim* f = &s_adxl_fifo;
+		if (f->count)
+			memcpy(s_adxl_out, f->s[(f->tail + f->count - 1) % FIFO_SIZE],
+				   sizeof(s_adxl_out));
+		fifo_clear(f);
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+// gyro and accelerometer drivers
+
+uint8_t hal_gyro_drdy(void)
+{
+	return l3g4200d_line();
+}
+
+void l3g4200d_init(void)
+{
+}
+
+void l3g4200d_self_test(void)
+{
+}
+
+void l3g4200d_read_data(l3g4200d_dev_t* dev)
+{
+	const struct sample* s = sample_at(host_now());
+	for (uint8_t i=0; i<3; ++i)
+		dev->raw[i] = s->gyro[i];
+	s_drdy = 0;
+}
+
+int16_t l3g4200d_raw_data(l3g4200d_dev_t* dev, uint8_t axis)
+{
+	return dev->raw[axis];
+}
+
+void adxl345_init(struct adxl345_device* dev)
+{
+}
+
+uint8_t adxl345_self_test(void)
+{
+	return 0;
+}
+
+void adxl345_internal_self_test(void)
+{
+}
+
+void adxl345_read_accel(void)
+{
+	const struct sample* s = sample_at(host_now());
+	for (uint8_t i=0; i<3; ++i)
+		s_accel[i] = s->accel[i];
+}
+
+int16_t adxl345_accel(uint8_t axis)
+{
+	return s_accel[axis];
+}
+
+/*-----------------------------------------------------------------------*/
+
+// bmp085, the datasheet compensation, the sim inverts it to find the
+// raw values for the scripted temperature and pressure
+
+static int32_t bmp085_b5(int32_t ut)
+{
+	int32_t x1 = ((ut - (uint16_t)k_cal[5]) * (uint16_t)k_cal[4]) >> 15;
+	int32_t x2 = ((int32_t)k_cal[9] << 11) / (x1 + k_cal[10]);
+	return x1 + x2;
+}
+
+static int32_t bmp085_press(int32_t b5, int32_t up, uint8_t oss)
+{
+	int32_t b6 = b5 - 4000;
+	int32_t x1 = ((int32_t)k_cal[7] * ((b6 * b6) >> 12)) >> 11;
+	int32_t x2 = ((int32_t)k_cal[1] * b6) >> 11;
+	int32_t x3 = x1 + x2;
+	int32_t b3 = ((((int32_t)k_cal[0] * 4 + x3) << oss) + 2) / 4;
+	x1 = ((int32_t)k_cal[2] * b6) >> 13;
+	x2 = ((int32_t)k_cal[6] * ((b6 * b6) >> 12)) >> 16;
+	x3 = ((x1 + x2) + 2) >> 2;
+	uint32_t b4 = ((uint32_t)(uint16_t)k_cal[3]
+				   * (uint32_t)(x3 + 32768)) >> 15;
+	uint32_t b7 = ((uint32_t)up - b3) * (50000UL >> oss);
+	int32_t p = (b7 < 0x80000000UL) ? (b7 * 2) / b4 : (b7 / b4) * 2;
+	x1 = (p >> 8) * (p >> 8);
+	x1 = (x1 * 3038) >> 16;
+	x2 = (-7357 * p) >> 16;
+	return p + ((x1 + x2 + 3791) >> 4);
+}
+
+// raw temperature for 'temp' in 0.1 C
+static int32_t bmp085_ut(int16_t temp)
+{
+	int32_t lo = 0, hi = 65535;
+	while (lo < hi) {
+		int32_t mid = (lo + hi) / 2;
+		if (((bmp085_b5(mid) + 8) >> 4) < temp)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// raw pressure for 'press' in Pa
+static int32_t bmp085_up(int32_t b5, int32_t press, uint8_t oss)
+{
+	int32_t lo = 0, hi = (1L << (16 + oss)) - 1;
+	while (lo < hi) {
+		int32_t mid = (lo + hi) / 2;
+		if (bmp085_press(b5, mid, oss) < press)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static void bmp085_convert(uint8_t dev, uint8_t cmd)
+{
+	struct bmp085_sim* b = &s_baro[dev];
+	const struct sample* s = sample_at(host_now());
+	int32_t ut = bmp085_ut(s->temp);
+
+	if (cmd == 0x2e) {
+		b->adc[0] = (uint8_t)(ut >> 8);
+		b->adc[1] = (uint8_t)ut;
+		b->adc[2] = 0;
+		b->done = host_now() + 4500;
+		return;
+	}
+	uint8_t oss = cmd >> 6;
+	int32_t up = bmp085_up(bmp085_b5(ut), s->press[dev], oss) << (8 - oss);
+	b->adc[0] = (uint8_t)(up >> 16);
+	b->adc[1] = (uint8_t)(up >> 8);
+	b->adc[2] = (uint8_t)up;
+	b->done = host_now() + (3000UL << oss) + 1500;
+}
+
+static uint8_t bmp085_read_reg(struct bmp085_sim* b)
+{
+	uint8_t reg = b->reg++;
+	if (reg >= BMP085_CAL && reg < BMP085_CAL + BMP085_CAL_SIZE) {
+		uint16_t w = (uint16_t)k_cal[(reg - BMP085_CAL) / 2];
+		return (reg & 1) ? (uint8_t)w : (uint8_t)(w >> 8);
+	}
+	if (reg >= BMP085_ADC && reg < BMP085_ADC + 3)
+		return b->adc[reg - BMP085_ADC];
+	return 0;
+}
+
+uint8_t bmp085_init(uint8_t mode, struct bmp085_dev_t* dev)
+{
+	return BMP085_OK;
+}
+
+uint8_t bmp085_self_test(struct bmp085_dev_t* dev)
+{
+	return BMP085_OK;
+}
+
+void hal_baro_enable(uint8_t mask)
+{
+	s_xclr = mask;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// i2c bus, the adxl345 and the bmp085 out of reset answer
+
+void i2c_init(void)
+{
+}
+
+unsigned char i2c_start(unsigned char addr)
+{
+	s_bus_dev = -1;
+	if ((addr >> 1) == ADXL345_ADDR) {
+		s_bus_dev = 2;
+		s_bus_first = !(addr & I2C_READ);
+		return 0;
+	}
+	if ((addr >> 1) != BMP085_ADDR || s_xclr == 0)
+		return 1;
+	// with both out of reset they answer alike, take the first
+	s_bus_dev = (s_xclr & 1) ? 0 : 1;
+	s_bus_first = !(addr & I2C_READ);
+	return 0;
+}
+
+unsigned char i2c_rep_start(unsigned char addr)
+{
+	return i2c_start(addr);
+}
+
+void i2c_start_wait(unsigned char addr)
+{
+	i2c_start(addr);
+}
+
+void i2c_stop(void)
+{
+	s_bus_dev = -1;
+}
+
+unsigned char i2c_write(unsigned char data)
+{
+	if (s_bus_dev < 0)
+		return 1;
+	if (s_bus_dev == 2) {
+		adxl345_write(data);
+		return 0;
+	}
+	struct bmp085_sim* b = &s_baro[s_bus_dev];
+	if (s_bus_first) {
+		b->reg = data;
+		s_bus_first = 0;
+	} else if (b->reg++ == BMP085_CONTROL) {
+		bmp085_convert(s_bus_dev, data);
+	}
+	return 0;
+}
+
+unsigned char i2c_readAck(void)
+{
+	if (s_bus_dev == 2)
+		return adxl345_read_reg();
+	return (s_bus_dev < 0) ? 0xff : bmp085_read_reg(&s_baro[s_bus_dev]);
+}
+
+unsigned char i2c_readNak(void)
+{
+	return i2c_readAck();
+}
@@ -0,0 +1,99 @@
+#include <inttypes.h>
+
+#include "jitter.h"
+#include "sched.h"
+#include "timer.h"
+#include "conversion.h"
+
+/*-----------------------------------------------------------------------*/
+
+static uint16_t s_period_hist[JITTER_BUCKETS];
+static uint16_t s_exec_hist[JITTER_BUCKETS];
+static uint16_t s_late_periods;
+static uint16_t s_exec_misses;
+
+// start of the previous frame, period is unknown until it is set
+static uint32_t s_last_start;
+static uint8_t s_have_last;
+
+// bucket reported by the MIS data function
+static uint8_t s_selected;
+
+/*-----------------------------------------------------------------------*/
+
+// add one to a counter, stick at the maximum
+static void count(uint16_t* c)
+{
+	if (*c != 0xffff)
+		++*c;
+}
+
+static uint8_t bucket(uint32_t t, uint8_t width)
+{
+	uint32_t b = t / width;
+	return (b >= JITTER_BUCKETS) ? JITTER_BUCKETS - 1 : (uint8_t)b;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_frame(uint32_t start, uint32_t end)
+{
+	uint32_t exec = timer_elapsed(start, end);
+	count(&s_exec_hist[bucket(exec, JITTER_EXEC_WIDTH)]);
+	if (exec > JITTER_DEADLINE)
+		count(&s_exec_misses);
+
+	if (s_have_last) {
+		uint32_t period = timer_elapsed(s_last_start, start);
+		count(&s_period_hist[bucket(period, JITTER_PERIOD_WIDTH)]);
+		if (period > JITTER_DEADLINE + JITTER_PERIOD_SLACK)
+			count(&s_late_periods);
+	}
+	s_last_start = start;
+	s_have_last = 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_reset(void)
+{
+	for (uint8_t i=0; i<JITTER_BUCKETS; ++i) {
+		s_period_hist[i] = 0;
+		s_exec_hist[i] = 0;
+	}
+	s_late_periods = 0;
+	s_exec_misses = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_select(uint8_t bucket)
+{
+	s_selected = bucket;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_mis_bucket_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_period_hist[s_selected], &(msg->data[4]));
+	convert_ushort_to_big_endian(s_exec_hist[s_selected], &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_mis_misses_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_late_periods, &(msg->data[4]));
+	convert_ushort_to_big_endian(s_exec_misses, &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+void jitter_mis_sched_data(can_msg_t* msg)
+{
+	// the frame task is the first in the table
+	const sched_stat_t* s = sched_stats(0);
+	convert_ushort_to_big_endian(s->overruns, &(msg->data[4]));
+	convert_ushort_to_big_endian(s->late, &(msg->data[6]));
+}
@@ -0,0 +1,59 @@
+#ifndef JITTER_H_
+#define JITTER_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * 80hz frame timing histograms
+ *
+ * every frame adds its period (start to start) and its execution time
+ * to a fixed bucket histogram, all times are tenth ms from jiffie().
+ * The last bucket of each histogram also counts everything beyond it.
+ *
+ * MIS code JITTER_MIS_BUCKET + n returns bucket n of both histograms,
+ * JITTER_MIS_MISSES the deadline miss counters, JITTER_MIS_SCHED the
+ * scheduler overruns and late runs of the frame task. MCS code
+ * JITTER_MCS_RESET clears the histograms and the miss counters.
+ */
+
+// buckets in each histogram
+#define JITTER_BUCKETS          16
+
+// bucket widths in tenth ms, period covers 0..16ms, execution 0..3.2ms
+#define JITTER_PERIOD_WIDTH     10
+#define JITTER_EXEC_WIDTH       2
+
+// frame deadline, 12.5ms in tenth ms
+#define JITTER_DEADLINE         125
+
+// period jitter tolerated before a frame counts as late, the
+// period of consecutive ticks already varies by a tenth ms or two
+#define JITTER_PERIOD_SLACK     5
+
+// service codes
+#define JITTER_MIS_BUCKET       50
+#define JITTER_MIS_MISSES       70
+#define JITTER_MIS_SCHED        71
+#define JITTER_MCS_RESET        50
+
+// account a frame that started at 'start' and finished at 'end'
+extern void jitter_frame(uint32_t start, uint32_t end);
+
+// clear the histograms and miss counters
+extern void jitter_reset(void);
+
+// bucket reported by the next MIS reply
+extern void jitter_select(uint8_t bucket);
+
+// MIS data, USHORT2 period and execution count of the selected bucket
+extern void jitter_mis_bucket_data(can_msg_t* msg);
+
+// MIS data, USHORT2 late periods and execution over the deadline
+extern void jitter_mis_misses_data(can_msg_t* msg);
+
+// MIS data, USHORT2 scheduler overruns and late runs of the frame task
+extern void jitter_mis_sched_data(can_msg_t* msg);
+
+#endif  // JITTER_H_
@@ -0,0 +1,102 @@
+#include <inttypes.h>
+#include <util/atomic.h>
+
+#include "prof.h"
+#include "hal.h"
+#include "sched.h"
+#include "conversion.h"
+
+/*-----------------------------------------------------------------------*/
+
+// timer1 counts in one scheduler tick
+#define PROF_TICK_COUNTS (F_CPU / 8 / SCHED_TICK_HZ)
+
+struct prof_stat {
+	uint16_t min;
+	uint16_t max;
+	uint16_t count;
+	uint32_t sum;
+};
+
+static struct prof_stat s_stats[PROF_NUM_STAGES];
+
+// stage reported by the MIS data functions
+static uint8_t s_selected;
+
+/*-----------------------------------------------------------------------*/
+
+prof_time_t prof_begin(void)
+{
+	uint8_t ticks;
+	uint16_t cnt;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ticks = g_sched_ticks;
+		cnt = hal_timer1_count();
+		// the counter wrapped but the tick isn't counted yet
+		if (hal_timer1_match() && cnt < PROF_TICK_COUNTS / 2)
+			++ticks;
+	}
+	return ((uint32_t)ticks << 16) | cnt;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void prof_end(enum prof_stage stage, prof_time_t start)
+{
+	prof_time_t now = prof_begin();
+	uint8_t ticks = (uint8_t)(now >> 16) - (uint8_t)(start >> 16);
+	int32_t us = (int32_t)ticks * PROF_TICK_COUNTS
+		+ (int32_t)(uint16_t)now - (int32_t)(uint16_t)start;
+	uint16_t t = (us > 0xffff) ? 0xffff : (uint16_t)us;
+
+	struct prof_stat* s = &s_stats[stage];
+	if (s->count == 0 || t < s->min)
+		s->min = t;
+	if (t > s->max)
+		s->max = t;
+	if (s->count == 0xffff) {
+		s->count >>= 1;
+		s->sum >>= 1;
+	}
+	++s->count;
+	s->sum += t;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void prof_reset(void)
+{
+	for (uint8_t i=0; i<PROF_NUM_STAGES; ++i) {
+		s_stats[i].min = 0;
+		s_stats[i].max = 0;
+		s_stats[i].count = 0;
+		s_stats[i].sum = 0;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void prof_select(uint8_t stage)
+{
+	s_selected = stage;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void prof_mis_minmax_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(s_stats[s_selected].min, &(msg->data[4]));
+	convert_ushort_to_big_endian(s_stats[s_selected].max, &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+void prof_mis_avg_data(can_msg_t* msg)
+{
+	const struct prof_stat* s = &s_stats[s_selected];
+	uint16_t avg = s->count ? s->sum / s->count : 0;
+	convert_ushort_to_big_endian(avg, &(msg->data[4]));
+	convert_ushort_to_big_endian(s->count, &(msg->data[6]));
+}
@@ -0,0 +1,61 @@
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * per stage run time accounting
+ *
+ * times are taken from timer1 (1 us per count, 8 cpu cycles) plus the
+ * scheduler tick count, so a stage may span several ticks. min, max
+ * and average of each stage are read over CAN with MIS codes
+ * PROF_MIS_MINMAX + stage and PROF_MIS_AVG + stage, MCS code
+ * PROF_MCS_RESET clears them. When the count of a stage saturates it
+ * and the sum are halved, so the average keeps following.
+ */
+
+// stages of the main loop
+enum prof_stage {
+	PROF_CAN,
+	PROF_GYRO,
+	PROF_ACCEL,
+	PROF_ATTITUDE,
+	PROF_BARO,                  // start and collect conversions
+	PROF_AIRDATA,               // airdata_update()
+	PROF_SEND_CYCLE,
+	PROF_SEND_ACCEL,
+	PROF_SEND_GYRO,
+	PROF_SEND_ATTITUDE,
+	PROF_SEND_PRESSURE,
+	PROF_NUM_STAGES
+};
+
+// service codes, the MIS blocks are PROF_NUM_STAGES long
+#define PROF_MIS_MINMAX     20
+#define PROF_MIS_AVG        31
+#define PROF_MCS_RESET      20
+
+// timestamp, scheduler tick count and timer1 count
+typedef uint32_t prof_time_t;
+
+// timestamp the start of a stage
+extern prof_time_t prof_begin(void);
+
+// account the time since 'start' to a stage
+extern void prof_end(enum prof_stage stage, prof_time_t start);
+
+// clear all statistics
+extern void prof_reset(void);
+
+// stage reported by the next MIS reply
+extern void prof_select(uint8_t stage);
+
+// MIS data, USHORT2 min and max us
+extern void prof_mis_minmax_data(can_msg_t* msg);
+
+// MIS data, USHORT2 average us and number of samples
+extern void prof_mis_avg_data(can_msg_t* msg);
+
+#endif  // PROF_H_
@@ -0,0 +1,120 @@
+#include <inttypes.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "sched.h"
+#include "hal.h"
+#include "timer.h"
+
+/*-----------------------------------------------------------------------*/
+
+volatile uint8_t g_sched_ticks;
+
+static const sched_task_t* s_tasks;
+static uint8_t s_num_tasks;
+
+// ticks left until each task is released
+static uint8_t s_countdown[SCHED_MAX_TASKS];
+
+// bit set per released task
+static volatile uint8_t s_pending;
+
+static sched_stat_t s_stats[SCHED_MAX_TASKS];
+
+/*-----------------------------------------------------------------------*/
+
+void sched_init(const sched_task_t* tasks, uint8_t num_tasks)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		s_tasks = tasks;
+		s_num_tasks = num_tasks;
+		s_pending = 0;
+		for (uint8_t i=0; i<num_tasks; ++i) {
+			s_countdown[i] = pgm_read_byte(&tasks[i].phase);
+			s_stats[i].overruns = 0;
+			s_stats[i].late = 0;
+			s_stats[i].max_time = 0;
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void sched_tick(void)
+{
+	++g_sched_ticks;
+
+	uint8_t bit = 1;
+	for (uint8_t i=0; i<s_num_tasks; ++i, bit <<= 1) {
+		if (s_countdown[i]) {
+			--s_countdown[i];
+			continue;
+		}
+		s_countdown[i] = pgm_read_byte(&s_tasks[i].period) - 1;
+		// still waiting from the last release
+		if (s_pending & bit)
+			++s_stats[i].overruns;
+		s_pending |= bit;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void sched_dispatch(void)
+{
+	uint8_t bit = 1;
+	for (uint8_t i=0; i<s_num_tasks; ++i, bit <<= 1) {
+		if (!(s_pending & bit))
+			continue;
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			s_pending &= ~bit;
+		}
+
+		sched_task_t task;
+		memcpy_P(&task, &s_tasks[i], sizeof(task));
+
+		uint32_t start = jiffie();
+		task.fn();
+		uint16_t t = timer_elapsed(start, jiffie());
+
+		if (t > s_stats[i].max_time)
+			s_stats[i].max_time = t;
+		if (t > task.budget)
+			++s_stats[i].late;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t sched_idle(uint16_t us)
+{
+	uint16_t cnt;
+	uint8_t match;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		cnt = hal_timer1_count();
+		match = hal_timer1_match();
+	}
+	// a tick that isn't serviced yet releases tasks as soon as it is
+	return !s_pending && !match && cnt + (uint32_t)us < SCHED_TICK_COUNTS;
+}
+
+/*-----------------------------------------------------------------------*/
+
+const sched_stat_t* sched_stats(uint8_t task)
+{
+	return &s_stats[task];
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint8_t sched_elapsed(uint8_t* last, uint8_t ticks)
+{
+	if ((uint8_t)(g_sched_ticks - *last) < ticks)
+		return 0;
+	*last += ticks;
+	return 1;
+}
@@ -0,0 +1,73 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * table driven cooperative scheduler
+ *
+ * the timer1 compare match calls sched_tick() at SCHED_TICK_HZ, it
+ * releases every task whose period and phase fall on that tick. The
+ * main loop calls sched_dispatch(), which runs the released tasks in
+ * table order. Tasks are never preempted, so the phases should be set
+ * so that the heavy tasks don't share a tick.
+ *
+ * background work asks sched_idle() before each slice of it, so a
+ * slice never holds up a task.
+ */
+
+// base tick rate
+#define SCHED_TICK_HZ    160
+
+// timer1 counts (us) in a base tick
+#define SCHED_TICK_COUNTS (F_CPU / 8 / SCHED_TICK_HZ)
+
+// most tasks the table can hold
+#define SCHED_MAX_TASKS  8
+
+// period of a task running at 'hz'
+#define SCHED_PERIOD(hz) (SCHED_TICK_HZ / (hz))
+
+typedef void (sched_task_fn)(void);
+
+// static description of a task
+typedef struct sched_task {
+	uint8_t period;         // base ticks between releases
+	uint8_t phase;          // tick within the period it is released on
+	uint16_t budget;        // worst case run time, tenth ms
+	sched_task_fn* fn;
+} sched_task_t;
+
+// run time statistics of a task
+typedef struct sched_stat {
+	uint16_t overruns;      // released again before it had run
+	uint16_t late;          // ran longer than its budget
+	uint16_t max_time;      // longest run, tenth ms
+} sched_stat_t;
+
+// free running count of base ticks
+extern volatile uint8_t g_sched_ticks;
+
+// set the task table, tasks are released from the next tick
+// the table is read from flash, it has to be declared PROGMEM, and
+// it has at most SCHED_MAX_TASKS entries
+extern void sched_init(const sched_task_t* tasks, uint8_t num_tasks);
+
+// release the tasks due on this tick, called from the timer interrupt
+extern void sched_tick(void);
+
+// run the released tasks
+extern void sched_dispatch(void);
+
+// returns 1 if no task is released and 'us' fit in before the next
+// tick
+extern uint8_t sched_idle(uint16_t us);
+
+// statistics of a task
+extern const sched_stat_t* sched_stats(uint8_t task);
+
+// returns 1 and advances 'last' when 'ticks' have passed since 'last'
+extern uint8_t sched_elapsed(uint8_t* last, uint8_t ticks);
+
+#endif  // SCHED_H_
@@ -0,0 +1,76 @@
+#include <inttypes.h>
+#include "stackmon.h"
+#include "conversion.h"
+#include "hal.h"
+
+/*-----------------------------------------------------------------------*/
+
+// lowest byte found overwritten so far
+static uint8_t* s_mark;
+
+// next byte to check, runs from the bottom up to the mark
+static uint8_t* s_scan;
+
+/*-----------------------------------------------------------------------*/
+
+void stackmon_paint(void)
+{
+	uint8_t* p = hal_heap_start();
+	uint8_t* end = hal_stack_pointer() - STACKMON_GUARD;
+
+	while (p < end)
+		*p++ = STACKMON_PAINT;
+	s_mark = end;
+	s_scan = hal_heap_start();
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stackmon_scan(void)
+{
+	for (uint8_t i=0; i<STACKMON_SCAN_STEP; ++i) {
+		if (s_scan >= s_mark) {
+			// nothing new below the mark, start over
+			s_scan = hal_heap_start();
+			return;
+		}
+		if (*s_scan != STACKMON_PAINT) {
+			s_mark = s_scan;
+			s_scan = hal_heap_start();
+			return;
+		}
+		++s_scan;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t stackmon_peak(void)
+{
+	return hal_ram_end() - s_mark + 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t stackmon_unused(void)
+{
+	return s_mark - hal_heap_start();
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stackmon_mis_stack_data(can_msg_t* msg)
+{
+	convert_ushort_to_big_endian(stackmon_peak(), &(msg->data[4]));
+	convert_ushort_to_big_endian(stackmon_unused(), &(msg->data[6]));
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stackmon_mis_ram_data(can_msg_t* msg)
+{
+	uint16_t statics = hal_heap_start() - hal_ram_start();
+	uint16_t free = hal_stack_pointer() - hal_heap_start();
+	convert_ushort_to_big_endian(statics, &(msg->data[4]));
+	convert_ushort_to_big_endian(free, &(msg->data[6]));
+}
@@ -0,0 +1,48 @@
+#ifndef STACKMON_H_
+#define STACKMON_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * stack high water mark
+ *
+ * the ram between the end of the static data and the stack is painted
+ * at start up, the main loop then looks for the lowest byte that has
+ * been overwritten, a few bytes per pass. Reported over CAN with MIS
+ * codes STACKMON_MIS_STACK and STACKMON_MIS_RAM.
+ */
+
+// value the free ram is painted with
+#define STACKMON_PAINT          0xc5
+
+// bytes below the stack pointer left alone when painting
+#define STACKMON_GUARD          16
+
+// bytes checked on each call to stackmon_scan()
+#define STACKMON_SCAN_STEP      32
+
+// service codes
+#define STACKMON_MIS_STACK      13
+#define STACKMON_MIS_RAM        14
+
+// paint the free ram, called first thing from system_start()
+extern void stackmon_paint(void);
+
+// look for the high water mark, called from the idle loop
+extern void stackmon_scan(void);
+
+// most stack used since start up, in bytes
+extern uint16_t stackmon_peak(void);
+
+// ram never touched by the stack since start up, in bytes
+extern uint16_t stackmon_unused(void);
+
+// MIS data, USHORT2 stack peak and never touched bytes
+extern void stackmon_mis_stack_data(can_msg_t* msg);
+
+// MIS data, USHORT2 static data+bss bytes and current free bytes
+extern void stackmon_mis_ram_data(can_msg_t* msg);
+
+#endif  // STACKMON_H_
@@ -0,0 +1,104 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <util/crc16.h>
+
+#include "telem.h"
+#include "globals.h"
+#include "accel.h"
+#include "gyro.h"
+#include "baro.h"
+#include "timer.h"
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t s_enabled;
+
+static uint8_t s_seq;
+
+// raw frame, length + payload + crc
+static uint8_t s_frame[TELEM_PAYLOAD_SIZE + 3];
+
+/*-----------------------------------------------------------------------*/
+
+static uint8_t* put16(uint8_t* p, uint16_t v)
+{
+	*p++ = v >> 8;
+	*p++ = v;
+	return p;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t v)
+{
+	p = put16(p, v >> 16);
+	return put16(p, v);
+}
+
+// one encoded byte, nothing sent can be a '\n'
+static void telem_putc(uint8_t c)
+{
+	putchar(c ^ '\n');
+}
+
+void telem_send(uint8_t* buf, uint8_t len)
+{
+	uint16_t crc = 0xffff;
+	for (uint8_t i=0; i<len; ++i)
+		crc = _crc_ccitt_update(crc, buf[i]);
+	buf[len] = crc >> 8;
+	buf[len + 1] = crc;
+	len += 2;
+
+	// COBS, a code byte before each run of non zero bytes takes the
+	// place of the zero after it
+	uint8_t i = 0;
+	while (i <= len) {
+		// the run up to the next zero, or the end of the frame
+		uint8_t run = 0;
+		while (i + run < len && buf[i + run] != 0)
+			++run;
+		telem_putc(run + 1);
+		for (uint8_t j=0; j<run; ++j)
+			telem_putc(buf[i + j]);
+		i += run + 1;
+	}
+	putchar('\n');
+}
+
+/*-----------------------------------------------------------------------*/
+
+void telem_enable(uint8_t on)
+{
+	s_enabled = on;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void telem_frame(void)
+{
+	if (!s_enabled)
+		return;
+
+	uint8_t* p = s_frame;
+	*p++ = TELEM_PAYLOAD_SIZE;
+	*p++ = s_seq++;
+	p = put32(p, jiffie());
+	for (uint8_t i=0; i<3; ++i)
+		p = put16(p, gyro_rate(i));
+	for (uint8_t i=0; i<3; ++i)
+		p = put16(p, accel_value(i));
+	p = put32(p, g_bmp085_data[0].press);
+	p = put32(p, g_bmp085_data[1].press);
+	// the temperature calib.c compensates with, 0 until there is one
+	int16_t temp = 0;
+	baro_board_temperature(&temp);
+	p = put16(p, temp);
+
+	telem_send(s_frame, p - s_frame);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void telem_mis_data(can_msg_t* msg)
+{
+	msg->data[4] = s_enabled;
+}
@@ -0,0 +1,53 @@
+#ifndef TELEM_H_
+#define TELEM_H_
+
+#include <inttypes.h>
+#include "canaero.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * framed binary telemetry on the uart
+ *
+ * every 80hz frame sends all raw (uncalibrated) samples through
+ * stdout, so it shares the uart fifo with the text output. A frame
+ * before encoding is
+ *   length, sequence, jiffie (32 bits), gyro[3], accel[3],
+ *   static, total pressure (32 bits), board temperature, crc16
+ * multi byte values are big endian, length counts the bytes between
+ * it and the crc, the crc (_crc_ccitt_update from 0xffff) covers
+ * everything before it. The frame is COBS encoded, xor'ed with '\n'
+ * so it has no '\n' in it, and terminated by '\n'. A line feed
+ * translation in the uart driver only adds a '\r' before the end.
+ *
+ * every binary frame on the uart goes out through telem_send(), whole
+ * and from the main loop, so a frame is never split by other output.
+ * The first byte tells them apart, the length TELEM_PAYLOAD_SIZE here,
+ * TRACE_FRAME for the trace records of trace.h.
+ *
+ * tools/telemcap.py records the stream and counts the lost frames.
+ * Enabled at run time with MCS code TELEM_MCS_ENABLE, the setting is
+ * kept in the config, TELEMETRY on the compiler command line makes
+ * it the default.
+ */
+
+// service codes
+#define TELEM_MCS_ENABLE        16
+#define TELEM_MIS_ENABLE        16
+
+// payload bytes of a frame, without the length and crc
+#define TELEM_PAYLOAD_SIZE      27
+
+// crc, COBS encode and send a frame of 'len' bytes, buf needs 2 more
+// bytes for the crc
+extern void telem_send(uint8_t* buf, uint8_t len);
+
+// start or stop the stream
+extern void telem_enable(uint8_t on);
+
+// send one frame, if enabled, called every 80hz frame
+extern void telem_frame(void);
+
+// MIS/MCS data, UCHAR stream on/off
+extern void telem_mis_data(can_msg_t* msg);
+
+#endif  // TELEM_H_
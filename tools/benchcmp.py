@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# compare the simulavr benchmark counts against the baseline
+#
+# usage: benchcmp.py [-t percent] [-u] baseline.txt output.txt
+#
+# output.txt is what the benchmark image wrote (see bench/bench.h),
+# lines "bench <name> <cycles>", other text is skipped. A path that
+# takes more than 'percent' more cycles than its baseline, is in the
+# baseline but wasn't run, or was run but has no baseline (or a 0 one)
+# fails. A baseline file without any counts, before the first
+# "make bench_baseline", only lists the counts and doesn't fail.
+# -u writes the counts as the baseline.
+#
+
+import argparse
+import sys
+
+
+def read_counts(path, prefix):
+    """name -> cycles, from lines '[prefix] name cycles'"""
+    counts = {}
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.split('#', 1)[0].split()
+            if prefix:
+                if not line or line[0] != prefix:
+                    continue
+                line = line[1:]
+            if len(line) == 2 and line[1].isdigit():
+                counts[line[0]] = int(line[1])
+    return counts
+
+
+def write_baseline(path, counts):
+    with open(path, 'w') as f:
+        f.write('# simulavr cycle counts of the hot paths, see bench/bench.h\n')
+        f.write('# written by "make bench_baseline"\n')
+        for name, cycles in counts.items():
+            f.write('%-24s %d\n' % (name, cycles))
+
+
+def main():
+    p = argparse.ArgumentParser(description='check the benchmark counts')
+    p.add_argument('-t', '--threshold', type=float, default=5.0,
+                   help='allowed increase, percent')
+    p.add_argument('-u', '--update', action='store_true',
+                   help='write the counts as the new baseline')
+    p.add_argument('baseline')
+    p.add_argument('output')
+    args = p.parse_args()
+
+    counts = read_counts(args.output, 'bench')
+    if not counts:
+        sys.exit('%s: no benchmark counts, did the image run?' % args.output)
+    if args.update:
+        write_baseline(args.baseline, counts)
+        print('%d counts written to %s' % (len(counts), args.baseline))
+        return
+
+    try:
+        base = read_counts(args.baseline, None)
+    except FileNotFoundError:
+        base = {}
+    if not base:
+        print('%-24s %10s' % ('path', 'cycles'))
+        for name, cycles in counts.items():
+            print('%-24s %10d' % (name, cycles))
+        print('no baseline recorded in %s, nothing to compare, '
+              '"make bench_baseline" records one' % args.baseline)
+        return
+
+    failed = 0
+    print('%-24s %10s %10s %8s' % ('path', 'baseline', 'cycles', 'change'))
+    for name, cycles in counts.items():
+        if not base.get(name):
+            print('%-24s %10s %10d %8s  NO BASELINE'
+                  % (name, base.get(name, '-'), cycles, ''))
+            failed += 1
+            continue
+        old = base[name]
+        change = (cycles - old) * 100.0 / old
+        mark = ''
+        if change > args.threshold:
+            mark = '  REGRESSION'
+            failed += 1
+        print('%-24s %10d %10d %+7.1f%%%s' % (name, old, cycles, change, mark))
+    for name in base:
+        if name not in counts:
+            print('%-24s %10d %10s %8s  MISSING' % (name, base[name], '-', ''))
+            failed += 1
+
+    if failed:
+        sys.exit('%d paths over the %.1f%% threshold, missing or without a '
+                 'baseline, "make bench_baseline" records a new one'
+                 % (failed, args.threshold))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+#
+# fit the inertial sensor calibration (see calib.h) from raw telemetry
+# recorded by telemcap.py, and write it as an eeprom image
+#
+# usage: calfit.py [--accel=POS=FILE]... [--gyro=RATE=FILE]... -o calib.hex
+# (use the --opt=value form, a position like -x looks like an option)
+#
+#   --accel=+z=flat.csv     accels at rest, POS is the axis and sign that
+#                           reads +1g (x long, y lat, z normal)
+#   --gyro=0=still.csv      gyros at rest
+#   --gyro=+z:90=turn.csv   constant rate on a rate table, axis, sign and
+#                           rate in deg/s (x pitch, y roll, z yaw)
+#
+# six accel positions give bias, scale and misalignment, fewer give the
+# bias only. The bias temperature polynomial comes from the spread of
+# the board temperature over all files. Program the result with
+#   avrdude -U eeprom:w:calib.hex:i
+#
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+AXES = {'x': 0, 'y': 1, 'z': 2}
+GYRO_COLS = ('pitch_rate', 'roll_rate', 'yaw_rate')
+ACCEL_COLS = ('long_accel', 'lat_accel', 'norm_accel')
+
+
+def read_defines(*paths):
+    """integer #defines of the firmware headers"""
+    defs = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                m = re.match(r'#define\s+(\w+)\s+(0x[0-9a-fA-F]+|\d+)L?\b',
+                             line)
+                if m:
+                    defs[m.group(1)] = int(m.group(2), 0)
+    return defs
+
+
+def read_csv(path, cols):
+    """(temperature in 0.1 C, [3 raw counts]) of each frame"""
+    rows = []
+    with open(path) as f:
+        names = f.readline().strip().split(',')
+        idx = [names.index(c) for c in cols]
+        ti = names.index('temp_c')
+        for line in f:
+            v = line.strip().split(',')
+            if len(v) != len(names):
+                continue
+            rows.append((round(float(v[ti]) * 10),
+                         [float(v[i]) for i in idx]))
+    if not rows:
+        sys.exit('%s: no frames' % path)
+    return rows
+
+
+def solve(a, b):
+    """solve a x = b by gaussian elimination with pivoting"""
+    n = len(b)
+    m = [list(a[i]) + [b[i]] for i in range(n)]
+    for c in range(n):
+        p = max(range(c, n), key=lambda r: abs(m[r][c]))
+        if abs(m[p][c]) < 1e-12:
+            sys.exit('calfit: not enough independent positions')
+        m[c], m[p] = m[p], m[c]
+        for r in range(n):
+            if r != c:
+                f = m[r][c] / m[c][c]
+                m[r] = [x - f * y for x, y in zip(m[r], m[c])]
+    return [m[i][n] / m[i][i] for i in range(n)]
+
+
+def lstsq(rows, ys):
+    """least squares fit of ys to the rows of the design matrix"""
+    n = len(rows[0])
+    ata = [[sum(r[i] * r[j] for r in rows) for j in range(n)]
+           for i in range(n)]
+    aty = [sum(r[i] * y for r, y in zip(rows, ys)) for i in range(n)]
+    return solve(ata, aty)
+
+
+def invert3(k):
+    cols = [solve(k, [1.0 if i == j else 0.0 for i in range(3)])
+            for j in range(3)]
+    return [[cols[j][i] for j in range(3)] for i in range(3)]
+
+
+def fit(sets, tref):
+    """sets of (expected counts [3], frames), returns bias, matrix"""
+    means = []
+    for expect, frames in sets:
+        means.append((expect, [sum(f[1][i] for f in frames) / len(frames)
+                               for i in range(3)]))
+
+    # raw = K expect + b, needs 3 independent directions plus the bias
+    dirs = [e for e, _ in means if any(e)]
+    if len(dirs) >= 3:
+        k = []
+        for i in range(3):
+            x = lstsq([e + [1.0] for e, _ in means], [m[i] for _, m in means])
+            k.append(x[:3])
+    else:
+        k = [[1.0 if i == j else 0.0 for j in range(3)] for i in range(3)]
+
+    # what is left over is the bias, fit against the temperature
+    temps = [f[0] - tref for _, frames in sets for f in frames]
+    span = max(temps) - min(temps)
+    order = 2 if span >= 100 else 1 if span >= 20 else 0
+    bias = []
+    for i in range(3):
+        rows, ys = [], []
+        for expect, frames in sets:
+            ke = sum(k[i][j] * expect[j] for j in range(3))
+            for t, raw in frames:
+                dt = t - tref
+                rows.append([1.0, dt, dt * dt][:order + 1])
+                ys.append(raw[i] - ke)
+        c = lstsq(rows, ys) + [0.0] * (2 - order)
+        bias.append([c[0], c[1] * 256.0, c[2] * 65536.0])
+    return bias, invert3(k), span
+
+
+def q16(v):
+    v = int(round(v))
+    if v < -32768 or v > 32767:
+        sys.exit('calfit: coefficient %d out of range' % v)
+    return v
+
+
+def pack_coef(bias, matrix, one):
+    vals = [q16(c) for b in bias for c in b]
+    vals += [q16(m * one) for row in matrix for m in row]
+    return struct.pack('<18h', *vals)
+
+
+def crc16(data):
+    """avr-libc _crc16_update from 0xffff"""
+    crc = 0xffff
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xa001 if crc & 1 else crc >> 1
+    return crc
+
+
+def intel_hex(addr, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        chunk = data[i:i + 16]
+        a = addr + i
+        rec = bytes([len(chunk), a >> 8, a & 0xff, 0]) + chunk
+        lines.append(':%s%02X' % (rec.hex().upper(), -sum(rec) & 0xff))
+    lines.append(':00000001FF')
+    return '\n'.join(lines) + '\n'
+
+
+def parse_accel(spec, lsb_per_g):
+    m = re.match(r'([+-])([xyz])$', spec)
+    if not m:
+        sys.exit('calfit: bad accel position %s' % spec)
+    e = [0.0, 0.0, 0.0]
+    e[AXES[m.group(2)]] = lsb_per_g * (1 if m.group(1) == '+' else -1)
+    return e
+
+
+def parse_gyro(spec, udps_per_lsb):
+    if spec == '0':
+        return [0.0, 0.0, 0.0]
+    m = re.match(r'([+-])([xyz]):([0-9.]+)$', spec)
+    if not m:
+        sys.exit('calfit: bad gyro rate %s' % spec)
+    e = [0.0, 0.0, 0.0]
+    rate = float(m.group(3)) * 1e6 / udps_per_lsb
+    e[AXES[m.group(2)]] = rate * (1 if m.group(1) == '+' else -1)
+    return e
+
+
+def main():
+    here = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    p = argparse.ArgumentParser(description='fit the sensor calibration')
+    p.add_argument('--accel', action='append', default=[],
+                   metavar='POS=FILE')
+    p.add_argument('--gyro', action='append', default=[],
+                   metavar='RATE=FILE')
+    p.add_argument('-o', '--output', default='calib.hex')
+    args = p.parse_args()
+
+    d = read_defines(os.path.join(here, 'defs.h'),
+                     os.path.join(here, 'calib.h'))
+    tref = d['CALIB_TREF']
+    one = d['CALIB_ONE']
+
+    result = {}
+    for name, specs, cols, parse, scale in (
+            ('gyro', args.gyro, GYRO_COLS, parse_gyro,
+             d['GYRO_UDPS_PER_LSB']),
+            ('accel', args.accel, ACCEL_COLS, parse_accel,
+             d['ACCEL_LSB_PER_G'])):
+        sets = []
+        for s in specs:
+            spec, _, path = s.partition('=')
+            sets.append((parse(spec, scale), read_csv(path, cols)))
+        if sets:
+            bias, matrix, span = fit(sets, tref)
+            print('%s: temperature span %.1f C' % (name, span / 10.0))
+        else:
+            bias = [[0.0] * 3 for _ in range(3)]
+            matrix = [[1.0 if i == j else 0.0 for j in range(3)]
+                      for i in range(3)]
+            print('%s: no data, identity' % name)
+        for i in range(3):
+            print('  axis %d bias %8.2f %8.2f %8.2f  matrix %s' % (
+                i, bias[i][0], bias[i][1], bias[i][2],
+                ' '.join('%8.5f' % m for m in matrix[i])))
+        result[name] = pack_coef(bias, matrix, one)
+
+    block = bytes([d['EEPROM_CALIB_MAGIC'], d['CALIB_VERSION']])
+    block += result['gyro'] + result['accel']
+    block += struct.pack('<H', crc16(block))
+    with open(args.output, 'w') as f:
+        f.write(intel_hex(d['EEPROM_CALIB_ADDR'], block))
+    print('wrote %d bytes at 0x%x to %s' % (
+        len(block), d['EEPROM_CALIB_ADDR'], args.output))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# print the static ram of the linked image, .data + .bss + .noinit of
+# the elf, and what is left over for the stack. The modules' own
+# .data + .bss come from the object files, whatever they don't account
+# for (drivers in ../libs, avr-libc, libgcc) is "libraries/other"
+#
+# usage: ramsize.sh <avr-size> <ram bytes> <elf> <object files or directories>
+#
+
+SIZE=$1
+RAM=$2
+ELF=$3
+shift 3
+
+if [ ! -f "$ELF" ]; then
+	echo "ramsize: no $ELF"
+	exit 1
+fi
+
+OBJS=""
+for f in "$@"; do
+	if [ -d "$f" ]; then
+		OBJS="$OBJS `find "$f" -name '*.o' -o -name '*.obj'`"
+	elif [ -f "$f" ]; then
+		OBJS="$OBJS $f"
+	fi
+done
+
+if [ -z "$OBJS" ]; then
+	echo "ramsize: no object files"
+	exit 1
+fi
+
+TOTAL=`$SIZE -A "$ELF" | awk '
+$1 == ".data" || $1 == ".bss" || $1 == ".noinit" { total += $2 }
+END { print total + 0 }'`
+
+echo
+echo "RAM budget (data + bss bytes):"
+$SIZE -B $OBJS | awk 'NR > 1 {
+	n = $6
+	sub(".*/", "", n)
+	sub("\\.(c\\.)?o(bj)?$", "", n)
+	printf "%6d %6d %6d  %s\n", $2 + $3, $2, $3, n
+}' | sort -rn | awk -v ram=$RAM -v elf=$TOTAL '
+BEGIN { printf "%6s %6s %6s  %s\n", "ram", "data", "bss", "module" }
+{ print; modules += $1 }
+END {
+	printf "%6d %20s\n", elf - modules, "libraries/other"
+	printf "%6d %20s\n", elf, "total, linked"
+	printf "%6d %20s\n", ram - elf, "left for stack"
+}'
+echo
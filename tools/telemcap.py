@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+#
+# record the ahrs raw sample stream (see telem.h)
+#
+# usage: telemcap.py [-b baud] [-o out.csv] [file or serial device]
+#
+# frames are written as csv, text lines and trace records on the port
+# are skipped. The lost, bad and received frame counts are printed at
+# the end, ^C stops.
+#
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import tty
+
+TELEM_PAYLOAD_SIZE = 27
+
+COLUMNS = ('seq', 'time_s', 'pitch_rate', 'roll_rate', 'yaw_rate',
+           'long_accel', 'lat_accel', 'norm_accel', 'static_pa', 'total_pa',
+           'temp_c')
+
+
+def crc_ccitt(data):
+    """avr-libc _crc_ccitt_update from 0xffff"""
+    crc = 0xffff
+    for b in data:
+        b ^= crc & 0xff
+        b = (b ^ (b << 4)) & 0xff
+        crc = (((b << 8) | (crc >> 8)) ^ (b >> 4) ^ (b << 3)) & 0xffff
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def unframe(line):
+    """payload of a frame line with a good crc, or None, see telem.h"""
+    for data in (line, line[:-1] if line.endswith(b'\r') else None):
+        if not data:
+            continue
+        # the uart driver may have put a '\r' before the '\n'
+        raw = cobs_decode(bytes(b ^ 0x0a for b in data))
+        if raw is None or len(raw) < 3:
+            continue
+        if crc_ccitt(raw[:-2]) == struct.unpack('>H', raw[-2:])[0]:
+            return raw[:-2]
+    return None
+
+
+def decode(raw):
+    """telemetry sample from a frame payload, None for other frames"""
+    if len(raw) != TELEM_PAYLOAD_SIZE + 1 or raw[0] != TELEM_PAYLOAD_SIZE:
+        return None
+    return struct.unpack('>BI6h2ih', raw[1:])
+
+
+def open_input(path, baud):
+    if path is None:
+        return sys.stdin.buffer
+    f = open(path, 'rb', buffering=0)
+    if os.isatty(f.fileno()):
+        tty.setraw(f.fileno())
+        attr = termios.tcgetattr(f.fileno())
+        speed = getattr(termios, 'B%d' % baud)
+        attr[4] = attr[5] = speed
+        termios.tcsetattr(f.fileno(), termios.TCSANOW, attr)
+    return f
+
+
+def main():
+    p = argparse.ArgumentParser(description='record the ahrs raw samples')
+    p.add_argument('-b', '--baud', type=int, default=230400)
+    p.add_argument('-o', '--output', help='csv file, default stdout')
+    p.add_argument('input', nargs='?', help='capture file or tty')
+    args = p.parse_args()
+
+    src = open_input(args.input, args.baud)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write(','.join(COLUMNS) + '\n')
+
+    good = lost = bad = 0
+    last_seq = None
+    line = bytearray()
+    try:
+        while True:
+            b = src.read(1)
+            if not b:
+                break
+            if b != b'\n':
+                line += b
+                continue
+            raw = unframe(bytes(line))
+            line = bytearray()
+            if raw is None:
+                # a text line, or a frame that was hit
+                bad += 1
+                continue
+            frame = decode(raw)
+            if frame is None:
+                # a trace record, see tracedec.py
+                continue
+            seq = frame[0]
+            if last_seq is not None:
+                lost += (seq - last_seq - 1) & 0xff
+            last_seq = seq
+            good += 1
+            vals = list(frame)
+            vals[1] = '%.4f' % (frame[1] / 10000.0)
+            vals[10] = '%.1f' % (frame[10] / 10.0)
+            out.write(','.join(str(v) for v in vals) + '\n')
+    except KeyboardInterrupt:
+        pass
+    out.flush()
+    sys.stderr.write('%d frames, %d lost, %d bad or text lines\n'
+                     % (good, lost, bad))
+
+
+if __name__ == '__main__':
+    main()
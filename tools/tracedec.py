@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+#
+# decode the binary trace records in the ahrs serial output
+#
+# usage: tracedec.py [-t trace.h] [file or serial device]
+#
+# text on the port is passed through, records are printed as
+#   [seconds] EVENT: message
+# telemetry frames are left out. The event names and formats come from
+# the enum in trace.h
+#
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+from telemcap import unframe
+
+TRACE_FRAME = 0xa5
+TRACE_RECORD_SIZE = 10
+
+
+def read_events(path):
+    """event list from the enum in trace.h, in order"""
+    events = []
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'\s*(TRACE_\w+),\s*//\s*"(.*)"', line)
+            if m:
+                events.append((m.group(1), m.group(2)))
+    return events
+
+
+def format_record(events, rec):
+    """text of a record frame payload"""
+    event, time, a0, a1, a2 = struct.unpack('>BHHHH', rec[1:])
+    if event >= len(events):
+        return '[%7.4f] unknown event %d: %04x %04x %04x' % (
+            time / 10000.0, event, a0, a1, a2)
+    name, fmt = events[event]
+    args = []
+    for conv, v in zip(re.findall(r'%[-0-9]*([a-z])', fmt), (a0, a1, a2)):
+        if conv == 'd' and v & 0x8000:
+            v -= 0x10000
+        args.append(v)
+    return '[%7.4f] %s: %s' % (time / 10000.0, name[6:], fmt % tuple(args))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    p = argparse.ArgumentParser(description='decode the ahrs trace log')
+    p.add_argument('-t', '--trace-h', default=os.path.join(here, '..',
+                                                           'trace.h'))
+    p.add_argument('input', nargs='?', help='capture file or tty')
+    args = p.parse_args()
+
+    events = read_events(args.trace_h)
+    src = open(args.input, 'rb') if args.input else sys.stdin.buffer
+    out = sys.stdout
+
+    for line in src:
+        raw = unframe(line.rstrip(b'\n'))
+        if raw is None:
+            out.write(line.decode('ascii', 'replace'))
+        elif len(raw) == TRACE_RECORD_SIZE and raw[0] == TRACE_FRAME:
+            out.write(format_record(events, raw) + '\n')
+        out.flush()
+
+
+if __name__ == '__main__':
+    main()
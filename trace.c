@@ -0,0 +1,95 @@
+#include <inttypes.h>
+#include <util/atomic.h>
+
+#include "trace.h"
+#include "defs.h"
+#include "telem.h"
+#include "timer.h"
+#include "hal.h"
+
+/*-----------------------------------------------------------------------*/
+
+// telemcap.py tells the frames apart by the first byte, and a record
+// with its code, crc and line end fits the empty uart fifo
+STATIC_ASSERT(trace_frame, TRACE_FRAME != TELEM_PAYLOAD_SIZE
+			  && TRACE_RECORD_SIZE + 5 <= TX_FIFO_BUFFER_SIZE);
+
+struct trace_record {
+	uint8_t event;
+	uint16_t time;
+	uint16_t arg[3];
+};
+
+static struct trace_record s_ring[TRACE_RING_SIZE];
+static uint8_t s_head;
+static uint8_t s_tail;
+
+// records thrown away while the ring was full
+static uint16_t s_lost;
+
+// the record frame and its crc
+static uint8_t s_out[TRACE_RECORD_SIZE + 2];
+
+/*-----------------------------------------------------------------------*/
+
+// store a record, the ring must have room
+static void trace_put(uint8_t event, uint16_t arg0, uint16_t arg1,
+					  uint16_t arg2)
+{
+	struct trace_record* r = &s_ring[s_head];
+	r->event = event;
+	r->time = (uint16_t)jiffie();
+	r->arg[0] = arg0;
+	r->arg[1] = arg1;
+	r->arg[2] = arg2;
+	s_head = (s_head + 1) & (TRACE_RING_SIZE - 1);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void trace(enum trace_event event, uint16_t arg0, uint16_t arg1,
+		   uint16_t arg2)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uint8_t used = (s_head - s_tail) & (TRACE_RING_SIZE - 1);
+		// a pending lost count goes out first, one slot is kept free
+		// to tell a full ring from an empty one
+		uint8_t need = s_lost ? 2 : 1;
+		if (used + need > TRACE_RING_SIZE - 1) {
+			if (s_lost != 0xffff)
+				++s_lost;
+		} else {
+			if (s_lost) {
+				trace_put(TRACE_LOST, s_lost, 0, 0);
+				s_lost = 0;
+			}
+			trace_put(event, arg0, arg1, arg2);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void trace_drain(void)
+{
+	// the uart driver is sending, or the data register isn't free
+	if (!hal_uart_tx_idle() || s_head == s_tail)
+		return;
+
+	const struct trace_record* r = &s_ring[s_tail];
+	s_out[0] = TRACE_FRAME;
+	s_out[1] = r->event;
+	s_out[2] = r->time >> 8;
+	s_out[3] = r->time;
+	for (uint8_t i=0; i<3; ++i) {
+		s_out[4 + i * 2] = r->arg[i] >> 8;
+		s_out[5 + i * 2] = r->arg[i];
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		s_tail = (s_tail + 1) & (TRACE_RING_SIZE - 1);
+	}
+	// at most 15 bytes, they go into the empty uart fifo in one go
+	telem_send(s_out, TRACE_RECORD_SIZE);
+}
@@ -0,0 +1,52 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <inttypes.h>
+
+/*-----------------------------------------------------------------------*/
+/*
+ * deferred binary trace log
+ *
+ * trace() stores a fixed size record in a ram ring, that takes a few
+ * cycles and never waits on the uart. trace_drain() is called from the
+ * idle loop and sends one record at a time, whole, when the uart driver
+ * has nothing queued. All output to the uart comes from the main loop,
+ * so nothing gets into the middle of a record.
+ *
+ * on the wire a record is a frame of telem_send(), big endian:
+ *   TRACE_FRAME, event, jiffie (16 bits, tenth ms), arg0, arg1, arg2,
+ *   crc16
+ * COBS encoded, xor'ed with '\n' and terminated by '\n' like the
+ * telemetry, so it is a line of its own between the text lines.
+ * tools/tracedec.py turns them back into text, it reads the event
+ * list below, so the comment after each event is its format.
+ */
+
+// first byte of a record frame, never a telemetry length
+#define TRACE_FRAME             0xa5
+
+// bytes of a record frame before the crc
+#define TRACE_RECORD_SIZE       10
+
+// records held in the ring, power of 2
+#define TRACE_RING_SIZE         8
+
+// events
+enum trace_event {
+	TRACE_LOST,             // "%u records lost"
+	TRACE_CAN_ERROR,        // "can error:%d %d %d"
+	TRACE_EMERGENCY,        // "EE(%u):%d op/loc %04x"
+	TRACE_LISTEN,           // "EE:switching to listen mode"
+	TRACE_MIS_REPLY,        // "replied to MIS code %u, status %u"
+	TRACE_MCS_REPLY,        // "replied to MCS code %u, status %u"
+	TRACE_NUM_EVENTS
+};
+
+// log an event, safe to call from an interrupt
+extern void trace(enum trace_event event, uint16_t arg0, uint16_t arg1,
+				  uint16_t arg2);
+
+// send queued records while the uart is idle, called from the main loop
+extern void trace_drain(void);
+
+#endif  // TRACE_H_
@@ -0,0 +1,210 @@
+#include <inttypes.h>
+
+#include "vib.h"
+#include "defs.h"
+#include "fixmath.h"
+#include "hal.h"
+#include "sched.h"
+
+/*-----------------------------------------------------------------------*/
+
+// the slices have to come out even
+STATIC_ASSERT(vib_slice_samples, FFT_SIZE % VIB_SLICE_SAMPLES == 0);
+STATIC_ASSERT(vib_slice_butterflies,
+			  FFT_BUTTERFLIES % VIB_SLICE_BUTTERFLIES == 0);
+// the peak has a neighbour on both sides
+STATIC_ASSERT(vib_bin_lo, VIB_BIN_LO >= 2 && VIB_BIN_LO < FFT_BINS - 1);
+STATIC_ASSERT(vib_slice_bins, VIB_SLICE_BINS >= 1);
+
+enum vib_state {
+	VIB_COLLECT, VIB_WINDOW, VIB_BITREV, VIB_FFT, VIB_SPECTRUM, VIB_RESULT
+};
+
+// the block, samples and then the transform in place
+static int16_t s_buf[FFT_SIZE];
+static enum vib_state s_state;
+static uint8_t s_pos;           // sample, butterfly or bin of the state
+
+// block statistics for the window
+static int32_t s_sum;
+static int16_t s_min;
+static int16_t s_max;
+static int16_t s_mean;
+static uint8_t s_shift;
+
+// spectrum so far
+static uint32_t s_band;
+static uint32_t s_peak;
+static uint8_t s_peak_bin;
+
+// results
+static uint16_t s_frequency;
+static int16_t s_amplitude;
+static int16_t s_rms;
+static uint16_t s_blocks;
+
+/*-----------------------------------------------------------------------*/
+
+void vib_init(void)
+{
+	s_state = VIB_COLLECT;
+	s_pos = 0;
+	s_frequency = 0;
+	s_amplitude = 0;
+	s_rms = 0;
+	s_blocks = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void vib_sample(int16_t x)
+{
+	if (s_state != VIB_COLLECT)
+		return;
+	if (s_pos == 0) {
+		s_sum = 0;
+		s_min = x;
+		s_max = x;
+	}
+	s_buf[s_pos++] = x;
+	s_sum += x;
+	if (x < s_min)
+		s_min = x;
+	if (x > s_max)
+		s_max = x;
+
+	if (s_pos == FFT_SIZE) {
+		s_mean = (int16_t)(s_sum >> FFT_LOG2);
+		int16_t dev = s_max - s_mean;
+		if (s_mean - s_min > dev)
+			dev = s_mean - s_min;
+		s_shift = fft_scale(dev);
+		s_state = VIB_WINDOW;
+		s_pos = 0;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+void vib_restart(void)
+{
+	if (s_state == VIB_COLLECT)
+		s_pos = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+// scaled amplitude to mg
+static int16_t vib_mg(uint16_t v)
+{
+	int32_t mg = ((uint32_t)v * 1000 / ACCEL_LSB_PER_G) >> s_shift;
+	return (mg > INT16_MAX) ? INT16_MAX : (int16_t)mg;
+}
+
+static void vib_result(void)
+{
+	uint8_t k = s_peak_bin;
+	uint32_t lo = fft_power(s_buf, k - 1);
+	uint32_t hi = (k < FFT_BINS - 1) ? fft_power(s_buf, k + 1) : 0;
+
+	// a sine at k + d under the hann window has bins in the ratio
+	// m1 / m0 = (1 + d) / (2 - d), so d = (2 m1 - m0) / (m0 + m1) from
+	// the bigger neighbour m1
+	uint16_t m0 = fix_isqrt32(s_peak);
+	uint16_t m1 = fix_isqrt32(hi > lo ? hi : lo);
+	int32_t d = 0;
+	if (m0 + m1) {
+		d = ((2L * m1 - m0) * 256) / ((int32_t)m0 + m1);
+		if (d < 0)
+			d = 0;
+		else if (d > 128)
+			d = 128;
+		if (lo > hi)
+			d = -d;
+	}
+	s_frequency = (uint16_t)(((int32_t)k * 256 + d)
+		* (ACCEL_SAMPLE_HZ * 100L) / (FFT_SIZE * 256L));
+
+	// window gains, a sine is 8/3 of the power of its 3 bins, the
+	// square of the rms 4/3 of the band
+	s_amplitude = vib_mg(fix_isqrt32((lo + s_peak + hi) / 3 * 8));
+	s_rms = vib_mg(fix_isqrt32(s_band / 3 * 4));
+	++s_blocks;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void vib_task(void)
+{
+	uint16_t us = (s_state == VIB_RESULT) ? VIB_RESULT_US : VIB_SLICE_US;
+
+	if (s_state == VIB_COLLECT || !sched_idle(us))
+		return;
+	hal_busy(us);
+
+	switch (s_state) {
+	case VIB_WINDOW:
+		fft_window(s_buf, s_pos, VIB_SLICE_SAMPLES, s_mean, s_shift);
+		s_pos += VIB_SLICE_SAMPLES;
+		if (s_pos == FFT_SIZE)
+			s_state = VIB_BITREV;
+		break;
+	case VIB_BITREV:
+		fft_bitrev(s_buf);
+		s_state = VIB_FFT;
+		s_pos = 0;
+		break;
+	case VIB_FFT:
+		fft_butterflies(s_buf, s_pos, VIB_SLICE_BUTTERFLIES);
+		s_pos += VIB_SLICE_BUTTERFLIES;
+		if (s_pos == FFT_BUTTERFLIES) {
+			s_state = VIB_SPECTRUM;
+			s_pos = VIB_BIN_LO;
+			s_band = 0;
+			s_peak = 0;
+			s_peak_bin = VIB_BIN_LO;
+		}
+		break;
+	case VIB_SPECTRUM:
+		for (uint8_t n=0; n<VIB_SLICE_BINS && s_pos<FFT_BINS; ++n, ++s_pos) {
+			uint32_t p = fft_power(s_buf, s_pos);
+			s_band += p;
+			if (p > s_peak) {
+				s_peak = p;
+				s_peak_bin = s_pos;
+			}
+		}
+		if (s_pos == FFT_BINS)
+			s_state = VIB_RESULT;
+		break;
+	case VIB_RESULT:
+		vib_result();
+		s_state = VIB_COLLECT;
+		s_pos = 0;
+		break;
+	default:
+		break;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint16_t vib_frequency(void)
+{
+	return s_frequency;
+}
+
+int16_t vib_amplitude(void)
+{
+	return s_amplitude;
+}
+
+int16_t vib_rms(void)
+{
+	return s_rms;
+}
+
+uint16_t vib_blocks(void)
+{
+	return s_blocks;
+}
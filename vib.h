@@ -0,0 +1,79 @@
+#ifndef VIB_H_
+#define VIB_H_
+
+#include <inttypes.h>
+#include "accel.h"
+#include "fft.h"
+
+/*-----------------------------------------------------------------------*/
+/*
+ * vibration spectrum monitor
+ *
+ * the accelerometer hands every sample of the normal axis to
+ * vib_sample(), at ACCEL_SAMPLE_HZ. A block of FFT_SIZE of them goes
+ * through fft.c, 0.64 s at 200hz, 1.6 s at 80hz, with bins of
+ * ACCEL_SAMPLE_HZ / FFT_SIZE. Samples that come while a block is
+ * worked on are dropped, the next block starts when it is done.
+ *
+ * vib_task() runs from the main loop and does one slice of the work
+ * when sched_idle() says VIB_SLICE_US fit in before the next tick,
+ * so the 80hz frames don't move. The results are a slice of their
+ * own, given VIB_RESULT_US. A block takes about 40 slices.
+ *
+ * from the bins VIB_BIN_LO and up, below that is the flying itself:
+ *   frequency  of the biggest bin, moved by the ratio to its bigger
+ *              neighbour (exact for a sine under the Hann window),
+ *              in 0.01 hz
+ *   amplitude  of the sine there, from the power of the 3 bins around
+ *              it, in mg
+ *   rms        of the band, in mg
+ * the NOD payloads with FLOAT_NOD_DATA are hz and g. For a sine in the
+ * band the frequency is within 0.05 hz, amplitude and rms within 4 %,
+ * checked by host/fftbench.c.
+ */
+
+// accelerometer axis, normal
+#define VIB_AXIS              2
+
+// lowest bin looked at, the first from 5 hz
+#define VIB_BIN_LO \
+	((5 * FFT_SIZE + ACCEL_SAMPLE_HZ - 1) / ACCEL_SAMPLE_HZ)
+
+// avr cycles of a bin (fft_power() and the sums) and of the results
+// (2 bins, 4 square roots, 3 long divisions), counted from the code
+// as there is no baseline under simulavr yet, once one is recorded
+// VIB_BIN_CYCLES is its fft_power line plus 40
+#define VIB_BIN_CYCLES        560
+#define VIB_RESULT_CYCLES     6500
+
+// work done in a slice, and the time it is given, the bins fill 3/4
+// of it
+#define VIB_SLICE_SAMPLES     32
+#define VIB_SLICE_BUTTERFLIES 8
+#define VIB_SLICE_US          500
+#define VIB_SLICE_BINS \
+	(VIB_SLICE_US * (F_CPU / 1000000) * 3 / 4 / VIB_BIN_CYCLES)
+#define VIB_RESULT_US \
+	(VIB_RESULT_CYCLES * 4 / 3 / (F_CPU / 1000000))
+
+// start over
+extern void vib_init(void);
+
+// a new accelerometer sample
+extern void vib_sample(int16_t x);
+
+// the sample stream had a gap, start the block again
+extern void vib_restart(void);
+
+// a slice of the spectrum work, if there is time for it
+extern void vib_task(void);
+
+// results of the last block
+extern uint16_t vib_frequency(void);
+extern int16_t vib_amplitude(void);
+extern int16_t vib_rms(void);
+
+// number of blocks done
+extern uint16_t vib_blocks(void);
+
+#endif  // VIB_H_